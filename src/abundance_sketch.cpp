@@ -0,0 +1,158 @@
+/**
+ * @file abundance_sketch.cpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This file contains the merging, filtering and comparison of abundance sketches
+ */
+#include "abundance_sketch.hpp"
+
+/**
+ * @brief
+ * Turns a buffer holding one hash per kmer found into distinct hashes and their counts
+ *
+ * @param hashes buffer of hashes, sorted and without duplicates afterwards
+ * @param counts number of times each hash was in the buffer, replaced
+ */
+void count_sorted_hashes(std::vector<uint64_t> &hashes, std::vector<uint32_t> &counts)
+{
+    std::sort(hashes.begin(), hashes.end());
+    counts.clear();
+
+    size_t num_distinct = 0;
+    for (size_t i = 0; i < hashes.size();)
+    {
+        size_t run_end = i + 1;
+        while (run_end < hashes.size() && hashes[run_end] == hashes[i])
+            ++run_end;
+        hashes[num_distinct++] = hashes[i];
+        counts.push_back(run_end - i);
+        i = run_end;
+    }
+    hashes.resize(num_distinct);
+}
+
+/**
+ * @brief
+ * Helper function to merge a list of abundance sketches, adding up the counts of equal hashes
+ * This is the merge of the thread-local counts of the chunks of a file
+ * The (hash, count) pairs are concatenated and sorted once, as in the hash_sketch version
+ *
+ * @param abundance_sketches list of abundance sketches
+ * @return abundance_sketch containing every hash in the list, with the sum of its counts
+ */
+abundance_sketch merge_sketches(std::vector<abundance_sketch> &abundance_sketches)
+{
+    size_t total_size = 0;
+    for (const abundance_sketch &as : abundance_sketches)
+        total_size += as.hashes.size();
+
+    std::vector<std::pair<uint64_t, uint32_t>> hash_counts;
+    hash_counts.reserve(total_size);
+    for (const abundance_sketch &as : abundance_sketches)
+    {
+        for (size_t i = 0; i < as.hashes.size(); ++i)
+            hash_counts.emplace_back(as.hashes[i], as.counts[i]);
+    }
+    std::sort(hash_counts.begin(), hash_counts.end());
+
+    abundance_sketch merged;
+    merged.hashes.reserve(total_size);
+    merged.counts.reserve(total_size);
+    for (const auto &[hash, count] : hash_counts)
+    {
+        if (!merged.hashes.empty() && merged.hashes.back() == hash)
+        {
+            merged.counts.back() += count;
+        }
+        else
+        {
+            merged.hashes.push_back(hash);
+            merged.counts.push_back(count);
+        }
+    }
+    return merged;
+}
+
+/**
+ * @brief
+ * Removes the kmers found fewer than min_abundance times, e.g. min_abundance = 2 removes the singletons,
+ * most of which come from sequencing errors in read sets
+ *
+ * @param as abundance_sketch to be filtered
+ * @param min_abundance smallest count kept
+ * @return abundance_sketch of the kmers found at least min_abundance times
+ */
+abundance_sketch filter_by_abundance(const abundance_sketch &as, const uint32_t min_abundance)
+{
+    abundance_sketch filtered;
+    for (size_t i = 0; i < as.hashes.size(); ++i)
+    {
+        if (as.counts[i] >= min_abundance)
+        {
+            filtered.hashes.push_back(as.hashes[i]);
+            filtered.counts.push_back(as.counts[i]);
+        }
+    }
+    return filtered;
+}
+
+/**
+ * @brief
+ * Converts an abundance sketch into a hash_sketch of the kmers found at least min_abundance times,
+ * so that the filtered sketch can be compared with the hash_sketch functions
+ *
+ * @param as abundance_sketch to be converted
+ * @param min_abundance smallest count kept
+ * @return hash_sketch of the kmers found at least min_abundance times
+ */
+hash_sketch hash_sketch_from_abundance_sketch(const abundance_sketch &as, const uint32_t min_abundance)
+{
+    hash_sketch hs;
+    for (size_t i = 0; i < as.hashes.size(); ++i)
+    {
+        if (as.counts[i] >= min_abundance)
+            hs.hashes.push_back(as.hashes[i]);
+    }
+    return hs;
+}
+
+/**
+ * @brief
+ * Estimates the abundance-weighted containment of the first sample in the second: the fraction of the kmers of the
+ * first sample, counting repeated kmers every time, whose kmer is also in the second sample
+ * Unlike the containment of the kmer sets, abundant kmers (e.g. of the dominant organisms of a metagenome) weigh more
+ * than rare ones (e.g. sequencing errors)
+ *
+ * @param as1 first abundance_sketch
+ * @param as2 second abundance_sketch, built with the same parameters
+ * @return weighted containment of the first sample in the second, 0 if the first sketch is empty
+ */
+double weighted_containment(const abundance_sketch &as1, const abundance_sketch &as2)
+{
+    uint64_t shared_abundance = 0;
+    size_t i = 0, j = 0;
+    while (i < as1.hashes.size() && j < as2.hashes.size())
+    {
+        if (as1.hashes[i] < as2.hashes[j])
+        {
+            ++i;
+        }
+        else if (as2.hashes[j] < as1.hashes[i])
+        {
+            ++j;
+        }
+        else
+        {
+            shared_abundance += as1.counts[i];
+            ++i;
+            ++j;
+        }
+    }
+
+    const uint64_t total_abundance = as1.total_abundance();
+    return total_abundance == 0 ? 0.0 : (double)shared_abundance / total_abundance;
+}
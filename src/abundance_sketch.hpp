@@ -0,0 +1,68 @@
+/**
+ * @file abundance_sketch.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the abundance sketch, a hash_sketch which also keeps how many times each of its kmers occurs
+ * It is meant for read sets and metagenomes, where the abundance of a kmer tells sequencing errors (kmers seen once)
+ * apart from real kmers, and where the containment of a sample is better weighted by how abundant its kmers are
+ *
+ * Abundance sketches are counted in parallel with thread-local counts: every chunk of the input is counted into its
+ * own sketch (see abundance_sink and chunked_sketch_nucleotide_strings), and the chunk sketches are merged at the end
+ * by adding the counts of equal hashes, so no counter is shared between threads
+ */
+#ifndef ABUNDANCE_SKETCH_HPP
+#define ABUNDANCE_SKETCH_HPP
+#include "hash_sketch.hpp"
+
+/**
+ * @brief
+ * Sketch holding the sorted, distinct hashes of its kmers and the number of times each kmer was found
+ *
+ * @param hashes sorted hashes without duplicates
+ * @param counts number of occurrences of the kmer of each hash, counts[i] belonging to hashes[i]
+ */
+struct abundance_sketch
+{
+    std::vector<uint64_t> hashes;
+    std::vector<uint32_t> counts;
+
+    /**
+     * @brief
+     * Helper function for computing the size of the sketch
+     *
+     * @return int
+     */
+    inline int sketch_size() const
+    {
+        return hashes.size();
+    }
+
+    /**
+     * @brief
+     * Helper function for computing the total abundance of the sketch, i.e. the number of kmers counting repeated kmers every time
+     *
+     * @return uint64_t
+     */
+    inline uint64_t total_abundance() const
+    {
+        return std::accumulate(counts.begin(), counts.end(), (uint64_t)0);
+    }
+};
+
+// Helper function for turning a buffer of hashes into an abundance_sketch
+void count_sorted_hashes(std::vector<uint64_t> &hashes, std::vector<uint32_t> &counts);
+// Helper function for adding up the counts of a list of abundance sketches
+abundance_sketch merge_sketches(std::vector<abundance_sketch> &abundance_sketches);
+
+// Helper functions to filter abundance sketches before comparing them
+abundance_sketch filter_by_abundance(const abundance_sketch &as, const uint32_t min_abundance);
+hash_sketch hash_sketch_from_abundance_sketch(const abundance_sketch &as, const uint32_t min_abundance = 1);
+
+// Helper function for comparing abundance sketches
+double weighted_containment(const abundance_sketch &as1, const abundance_sketch &as2);
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ * @file all_pairs.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the all-pairs comparison engine, which intersects every unordered pair of sketches once
+ * Unlike generate_all_pairs_from_vector, no list of pairs is built: the pairs of the upper triangle are generated
+ * on the fly, tile by tile, and their results are passed on one row of tiles at a time
+ * The tiles of a batch of rows of tiles are computed together, so the workers do not wait for each other after every row
+ * Both containment directions of a pair come from its single intersection
+ */
+#ifndef ALL_PAIRS_HPP
+#define ALL_PAIRS_HPP
+#include "kmer.hpp"
+
+/**
+ * @brief
+ * Default number of sketches on each side of a tile
+ * A tile compares ALL_PAIRS_BLOCK_SIZE row sketches with ALL_PAIRS_BLOCK_SIZE column sketches,
+ * so that both blocks of sketches stay in cache while the tile is computed
+ */
+constexpr size_t DEFAULT_ALL_PAIRS_BLOCK_SIZE = 32;
+
+/**
+ * @brief
+ * Result of the comparison of two sketches, with i <= j
+ *
+ * @param i index of the first sketch
+ * @param j index of the second sketch
+ * @param intersection size of the intersection of the two sketches
+ */
+struct sketch_pair_intersection
+{
+    size_t i;
+    size_t j;
+    int intersection;
+};
+
+/**
+ * @brief
+ * Computes the intersection of every pair of sketches (i, j) with i < j (or i <= j if include_self_pairs),
+ * going through the upper triangle in tiles of block_size x block_size sketches
+ * The tiles of a batch of 4 * parallel_num_workers() rows of tiles are computed in parallel, as in
+ * for_each_indexed_intersection, then their results are passed to on_pairs on the calling thread, one row of tiles
+ * at a time and in increasing order of i, so only one batch of results is held at a time
+ * (batch_size * block_size * num_sketches results at most)
+ *
+ * @tparam sketch_t sketch type
+ * @param sketches list of sketch pointers
+ * @param intersect callable taking (const sketch_t &, const sketch_t &) and returning the intersection size
+ * @param on_pairs callable taking a const std::vector<sketch_pair_intersection> &, called once per row of tiles
+ * @param include_self_pairs whether the pairs (i, i) are included
+ * @param block_size number of sketches on each side of a tile
+ */
+template <typename sketch_t, typename intersection_callable, typename pairs_callable>
+void for_each_upper_triangle_intersection(
+    const std::vector<sketch_t *> &sketches,
+    intersection_callable &&intersect,
+    pairs_callable &&on_pairs,
+    const bool include_self_pairs = false,
+    const size_t block_size = DEFAULT_ALL_PAIRS_BLOCK_SIZE)
+{
+    if (block_size == 0)
+        throw std::runtime_error("Block size of the all-pairs comparison must be positive");
+
+    const size_t num_sketches = sketches.size();
+    const size_t num_blocks = (num_sketches + block_size - 1) / block_size;
+    const size_t batch_size = 4 * (size_t)parallel_num_workers();
+    // (row block, column block) of every tile of the current batch, in row order, and the results of each tile
+    std::vector<std::pair<size_t, size_t>> tiles;
+    std::vector<std::vector<sketch_pair_intersection>> tile_results;
+    std::vector<sketch_pair_intersection> row_results;
+
+    auto compute_tile = [&](const size_t tile)
+    {
+        const auto [row_block, column_block] = tiles[tile];
+        const size_t row_begin = row_block * block_size;
+        const size_t row_end = std::min(row_begin + block_size, num_sketches);
+        const size_t column_begin = column_block * block_size;
+        const size_t column_end = std::min(column_begin + block_size, num_sketches);
+        std::vector<sketch_pair_intersection> &results = tile_results[tile];
+        results.clear();
+        for (size_t i = row_begin; i < row_end; ++i)
+        {
+            // Only the upper triangle: j > i, or j >= i with the self pairs
+            for (size_t j = std::max(column_begin, include_self_pairs ? i : i + 1); j < column_end; ++j)
+                results.push_back({i, j, intersect(*sketches[i], *sketches[j])});
+        }
+    };
+
+    for (size_t batch_begin = 0; batch_begin < num_blocks; batch_begin += batch_size)
+    {
+        const size_t batch_end = std::min(batch_begin + batch_size, num_blocks);
+
+        tiles.clear();
+        for (size_t row_block = batch_begin; row_block < batch_end; ++row_block)
+        {
+            for (size_t column_block = row_block; column_block < num_blocks; ++column_block)
+                tiles.emplace_back(row_block, column_block);
+        }
+        if (tile_results.size() < tiles.size())
+            tile_results.resize(tiles.size());
+
+        // Debug: If the PARALLEL_DISABLE flag is set to 0, use the serial version
+        if (PARALLEL_DISABLE)
+        {
+            for (size_t tile = 0; tile < tiles.size(); ++tile)
+                compute_tile(tile);
+        }
+        else
+        {
+            parallel_for((size_t)0, tiles.size(), compute_tile);
+        }
+
+        // Results are passed on one row of tiles at a time, in increasing order of i
+        row_results.clear();
+        for (size_t tile = 0; tile < tiles.size(); ++tile)
+        {
+            row_results.insert(row_results.end(), tile_results[tile].begin(), tile_results[tile].end());
+            if (tiles[tile].second == num_blocks - 1)
+            {
+                on_pairs(row_results);
+                row_results.clear();
+            }
+        }
+    }
+}
+
+/**
+ * @brief
+ * Number of pairs visited by for_each_upper_triangle_intersection
+ *
+ * @param num_sketches number of sketches
+ * @param include_self_pairs whether the pairs (i, i) are included
+ * @return number of pairs
+ */
+inline size_t upper_triangle_pair_count(const size_t num_sketches, const bool include_self_pairs = false)
+{
+    return include_self_pairs ? num_sketches * (num_sketches + 1) / 2 : num_sketches * (num_sketches - (num_sketches > 0)) / 2;
+}
+
+#endif
@@ -39,4 +39,32 @@ double binomial_estimator(double containment, int kmer_num_ones)
 {
     if (containment <= 0) return 0;
     else return std::pow(containment, (((double)1.0) / ((double)kmer_num_ones)));
-}
\ No newline at end of file
+}
+/**
+ * @brief
+ * Helper function to compute the Jaccard index based on the intersection size and the union size
+ *
+ * @param intersection number of elements in the intersection
+ * @param union_size number of elements in the union
+ * @return double
+ */
+double jaccard(int intersection, int union_size)
+{
+    if (intersection == 0) return 0;
+    else return ((double)intersection) / ((double)union_size);
+}
+
+/**
+ * @brief
+ * Helper function to compute 1 + ln(2J / (1 + J)) / k, one minus the Mash distance, as an estimate of the ANI
+ * Counterpart of binomial_estimator for a Jaccard index, such as the one of bottom-k sketches
+ *
+ * @param jaccard Jaccard index
+ * @param kmer_num_ones number of positions used in the kmer
+ * @return double
+ */
+double mash_estimator(double jaccard, int kmer_num_ones)
+{
+    if (jaccard <= 0) return 0;
+    else return std::max(0.0, 1 + std::log(2 * jaccard / (1 + jaccard)) / ((double)kmer_num_ones));
+}
@@ -12,3 +12,5 @@
 #include "logging.hpp"
 double containment(int intersection, int set_size);
 double binomial_estimator(double containment, int kmer_num_ones);
+double jaccard(int intersection, int union_size);
+double mash_estimator(double jaccard, int kmer_num_ones);
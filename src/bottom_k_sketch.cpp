@@ -0,0 +1,153 @@
+/**
+ * @file bottom_k_sketch.cpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This file contains the construction and comparison of bottom-k sketches
+ */
+#include "bottom_k_sketch.hpp"
+#include "kmer_sliding.hpp"
+#include "ani_estimator.hpp"
+
+/**
+ * @brief
+ * Helper function that generates a bottom-k sketch from a list of ACGT strings already read from a file
+ * bottom_k_policy rejects the windows above its threshold before a kmer is built, and bottom_k_sink keeps the k smallest
+ * hashes of the rest, each in at most 2k hashes
+ *
+ * @param nucleotide_strings list of ACGT strings representing the ACGT nucleotides
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param k number of hashes kept
+ * @param fmh hash function whose hashes are stored in the sketch
+ * @return bottom_k_sketch of the kmers of the strings
+ */
+bottom_k_sketch bottom_k_sketch_from_nucleotide_strings(
+    const std::vector<acgt_string> &nucleotide_strings,
+    const kmer_bitset &mask,
+    const int window_length,
+    const size_t k,
+    const frac_min_hash &fmh)
+{
+    bottom_k_sketch bk;
+    bk.k = k;
+    bottom_k_policy policy(fmh, k);
+    bottom_k_sink sink(fmh, k, bk.hashes);
+    nucleotide_string_list_to_sink(sink, nucleotide_strings, mask, window_length, policy);
+    sink.finish();
+    return bk;
+}
+
+/**
+ * @brief
+ * Helper function that generates a bottom-k sketch from a .fasta file
+ *
+ * @param fasta_filename path to the .fasta file to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param k number of hashes kept
+ * @param fmh hash function whose hashes are stored in the sketch
+ * @return bottom_k_sketch of the kmers of that file
+ */
+bottom_k_sketch bottom_k_sketch_from_fasta_file(
+    const char fasta_filename[],
+    const kmer_bitset &mask,
+    const int window_length,
+    const size_t k,
+    const frac_min_hash &fmh)
+{
+    return bottom_k_sketch_from_nucleotide_strings(
+        nucleotide_strings_from_fasta_file(fasta_filename),
+        mask,
+        window_length,
+        k,
+        fmh);
+}
+
+/**
+ * @brief
+ * Generates the bottom-k sketch of every file of a list, in parallel over the files using parallel_for
+ *
+ * @param fasta_filenames list of file names to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param k number of hashes kept
+ * @param fmh hash function whose hashes are stored in the sketches
+ * @return a list of bottom_k_sketches corresponding to the file names given
+ */
+std::vector<bottom_k_sketch> parallel_bottom_k_sketches_from_fasta_files(
+    const std::vector<std::string> &fasta_filenames,
+    const kmer_bitset &mask,
+    const int window_length,
+    const size_t k,
+    const frac_min_hash &fmh)
+{
+    std::vector<bottom_k_sketch> bottom_k_sketches(fasta_filenames.size());
+    auto sketch_file = [&](const size_t i)
+    {
+        bottom_k_sketches[i] = bottom_k_sketch_from_fasta_file(fasta_filenames[i].c_str(), mask, window_length, k, fmh);
+    };
+
+    // Debug: If the PARALLEL_DISABLE flag is set to 0, use the serial version
+    if (PARALLEL_DISABLE)
+    {
+        for (size_t i = 0; i < fasta_filenames.size(); ++i)
+            sketch_file(i);
+    }
+    else
+    {
+        parallel_for((size_t)0, fasta_filenames.size(), sketch_file);
+    }
+    return bottom_k_sketches;
+}
+
+/**
+ * @brief
+ * Estimates the Jaccard index of the kmers of two genomes from their bottom-k sketches
+ * The min(k1, k2) smallest hashes of the union of the sketches are the bottom-k sketch of the union of the genomes,
+ * and the fraction of them found in both sketches estimates the Jaccard index
+ * A sketch holding fewer than k hashes holds its whole genome, so running out of its hashes loses nothing
+ *
+ * @param bk1 first bottom_k_sketch
+ * @param bk2 second bottom_k_sketch, built with the same mask, window length and hash function
+ * @return estimated Jaccard index
+ */
+double bottom_k_jaccard(const bottom_k_sketch &bk1, const bottom_k_sketch &bk2)
+{
+    const size_t k = std::min(bk1.k, bk2.k);
+    size_t i = 0, j = 0;
+    int union_size = 0, intersection = 0;
+    while ((size_t)union_size < k && (i < bk1.hashes.size() || j < bk2.hashes.size()))
+    {
+        const uint64_t h1 = i < bk1.hashes.size() ? bk1.hashes[i] : UINT64_MAX;
+        const uint64_t h2 = j < bk2.hashes.size() ? bk2.hashes[j] : UINT64_MAX;
+
+        intersection += (i < bk1.hashes.size() && j < bk2.hashes.size() && h1 == h2);
+        i += (h1 <= h2);
+        j += (h2 <= h1);
+        ++union_size;
+    }
+    return jaccard(intersection, union_size);
+}
+
+/**
+ * @brief
+ * Estimates the containment of the kmers of the first genome in the second from their bottom-k sketches
+ * Both sketches hold every kmer of their genome up to the smaller of their max_hash, so the hashes of the first sketch
+ * up to it are a uniform sample of the first genome whose membership in the second genome is known exactly
+ *
+ * @param bk1 first bottom_k_sketch
+ * @param bk2 second bottom_k_sketch, built with the same mask, window length and hash function
+ * @return estimated containment of the first genome in the second
+ */
+double bottom_k_containment(const bottom_k_sketch &bk1, const bottom_k_sketch &bk2)
+{
+    const uint64_t max_hash = std::min(bk1.max_hash(), bk2.max_hash());
+    const size_t size_1 = std::upper_bound(bk1.hashes.begin(), bk1.hashes.end(), max_hash) - bk1.hashes.begin();
+    const size_t size_2 = std::upper_bound(bk2.hashes.begin(), bk2.hashes.end(), max_hash) - bk2.hashes.begin();
+    const int intersection = sorted_hash_intersection(bk1.hashes.data(), size_1, bk2.hashes.data(), size_2);
+    return containment(intersection, size_1);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file bottom_k_sketch.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the bottom-k MinHash sketch, an alternative to kmer_set and to the FracMinHash hash_sketch
+ * whose size does not grow with the genome: it keeps the k smallest hashes of the kmers of a genome
+ * It is built with bottom_k_policy and bottom_k_sink, which hold a fixed number of hashes while the window slides,
+ * and two sketches are compared in O(k) whatever the size of the genomes
+ */
+#ifndef BOTTOM_K_SKETCH_HPP
+#define BOTTOM_K_SKETCH_HPP
+#include "kmer.hpp"
+#include "hash_sketch.hpp"
+
+/**
+ * @brief
+ * Sketch holding the k smallest distinct hashes of the kmers of a genome
+ * A genome with fewer than k distinct kmers keeps all of them, and the sketch is then exact
+ *
+ * @param k maximum number of hashes kept
+ * @param hashes sorted hashes without duplicates, at most k of them
+ */
+struct bottom_k_sketch
+{
+    size_t k = 0;
+    std::vector<uint64_t> hashes;
+
+    /**
+     * @brief
+     * Helper function for computing the size of the sketch
+     *
+     * @return int
+     */
+    inline int sketch_size() const
+    {
+        return hashes.size();
+    }
+
+    /**
+     * @brief
+     * Helper function for the largest hash the sketch is complete up to: every kmer of the genome
+     * with a hash up to it is in the sketch
+     *
+     * @return the largest hash of a full sketch, or UINT64_MAX for a sketch holding every kmer of its genome
+     */
+    inline uint64_t max_hash() const
+    {
+        return (hashes.size() < k || hashes.empty()) ? UINT64_MAX : hashes.back();
+    }
+};
+
+// Helper functions to compute bottom-k sketches
+bottom_k_sketch bottom_k_sketch_from_nucleotide_strings(
+    const std::vector<acgt_string> &nucleotide_strings,
+    const kmer_bitset &mask,
+    const int window_length,
+    const size_t k,
+    const frac_min_hash &fmh);
+bottom_k_sketch bottom_k_sketch_from_fasta_file(
+    const char fasta_filename[],
+    const kmer_bitset &mask,
+    const int window_length,
+    const size_t k,
+    const frac_min_hash &fmh);
+std::vector<bottom_k_sketch> parallel_bottom_k_sketches_from_fasta_files(
+    const std::vector<std::string> &fasta_filenames,
+    const kmer_bitset &mask,
+    const int window_length,
+    const size_t k,
+    const frac_min_hash &fmh);
+
+// Helper functions to estimate the similarity of bottom-k sketches
+double bottom_k_jaccard(const bottom_k_sketch &bk1, const bottom_k_sketch &bk2);
+double bottom_k_containment(const bottom_k_sketch &bk1, const bottom_k_sketch &bk2);
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * @file bounded_queue.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains a blocking queue of bounded capacity, used to connect the stages of the sketching pipeline
+ * A full queue blocks its producers, which keeps fast stages from running ahead of slow ones (backpressure)
+ */
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+
+/**
+ * @brief
+ * Multi-producer, multi-consumer FIFO queue holding at most capacity items
+ * Once closed, pushes fail and pops drain the remaining items before returning std::nullopt
+ *
+ * @tparam T type of the items, only needs to be movable
+ */
+template <typename T>
+struct bounded_queue
+{
+    explicit bounded_queue(const size_t capacity) : capacity(capacity)
+    {
+        if (capacity == 0)
+            throw std::runtime_error("Capacity of bounded_queue must be positive");
+    }
+
+    bounded_queue(const bounded_queue &) = delete;
+    bounded_queue &operator=(const bounded_queue &) = delete;
+
+    /**
+     * @brief
+     * Adds an item at the back of the queue, waiting while the queue is full
+     *
+     * @param item item to be added
+     * @return false if the queue was closed, in which case the item is dropped
+     */
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [&]
+                      { return closed || items.size() < capacity; });
+        if (closed)
+            return false;
+        items.push_back(std::move(item));
+        lock.unlock();
+        not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief
+     * Removes the item at the front of the queue, waiting while the queue is empty and open
+     *
+     * @return the item, or std::nullopt if the queue is closed and empty
+     */
+    std::optional<T> pop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [&]
+                       { return closed || !items.empty(); });
+        if (items.empty())
+            return std::nullopt;
+        std::optional<T> item(std::move(items.front()));
+        items.pop_front();
+        lock.unlock();
+        not_full.notify_one();
+        return item;
+    }
+
+    /**
+     * @brief
+     * Marks the end of the input, waking up every waiting producer and consumer
+     */
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+private:
+    size_t capacity;
+    bool closed = false;
+    std::deque<T> items;
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+};
+
+#endif
@@ -8,4 +8,8 @@
 # -I<boost library location>
 # -I<OpenCilk include path>
 # -lboost_system 
-# -O3 -static -Wall -fopencilk
\ No newline at end of file
+# -O3 -static -Wall -fopencilk
+# -march=native (optional, enables the AVX2 and BMI2 paths)
+
+# Without OpenCilk, any C++20 compiler works, using the built-in thread pool (see parallel.hpp):
+# g++ -std=c++20 -O3 -Wall -march=native -pthread *.cpp -o <executable file name> -I<boost library location>
@@ -11,10 +11,47 @@
  */
 
 #include "fasta_processing.hpp"
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 
 constexpr int FASTA_DEBUG = DEBUG | 0;
 
+/**
+ * @brief
+ * Number of characters encoded at once by encode_nucleotide_block
+ * This is the vector width when AVX2 or SSE2 is available
+ */
+#if defined(__AVX2__)
+constexpr int NUCLEOTIDE_BLOCK_SIZE = 32;
+#elif defined(__SSE2__)
+constexpr int NUCLEOTIDE_BLOCK_SIZE = 16;
+#else
+constexpr int NUCLEOTIDE_BLOCK_SIZE = 32;
+#endif
+
+/**
+ * @brief
+ * Lookup table from characters to the 2-bit words described in nucleotide_to_bits
+ */
+static constexpr std::array<uint8_t, 256> nucleotide_bits_table = []
+{
+    std::array<uint8_t, 256> table{};
+    table.fill(4);
+    table['A'] = table['a'] = 0;
+    table['C'] = table['c'] = 1;
+    table['G'] = table['g'] = 2;
+    table['T'] = table['t'] = 3;
+    return table;
+}();
+
 /**
  * @brief
  * Inlined function to convert nucleotide letters to 2-bit words
@@ -34,38 +71,76 @@ constexpr int FASTA_DEBUG = DEBUG | 0;
  */
 inline uint8_t nucleotide_to_bits(const char nucleotide)
 {
-    uint8_t ret_val = 0;
-    switch (nucleotide)
+    return nucleotide_bits_table[static_cast<uint8_t>(nucleotide)];
+}
+
+/**
+ * @brief
+ * Encodes a block of at most NUCLEOTIDE_BLOCK_SIZE characters one character at a time
+ * Used as the fallback when no vector instructions are available, and for the tail of a span
+ *
+ * @param chars pointer to the characters to be encoded
+ * @param block_length number of characters to be encoded
+ * @param codes output array of 2-bit nucleotide codes (garbage at non-ACGT positions)
+ * @return bitmask with bit i set iff chars[i] is not ACGT
+ */
+inline uint32_t encode_nucleotide_block_scalar(const char *chars, const int block_length, uint8_t *codes)
+{
+    uint32_t invalid_mask = 0;
+    for (int i = 0; i < block_length; ++i)
     {
-    case 'a':
-        ret_val = 0;
-        break;
-    case 'A':
-        ret_val = 0;
-        break;
-    case 'c':
-        ret_val = 1;
-        break;
-    case 'C':
-        ret_val = 1;
-        break;
-    case 'g':
-        ret_val = 2;
-        break;
-    case 'G':
-        ret_val = 2;
-        break;
-    case 't':
-        ret_val = 3;
-        break;
-    case 'T':
-        ret_val = 3;
-        break;
-    default:
-        ret_val = 4;
-        break;
+        uint8_t nucleotide_bits = nucleotide_to_bits(chars[i]);
+        codes[i] = nucleotide_bits & 0x3;
+        invalid_mask |= (uint32_t)(nucleotide_bits >> 2) << i;
     }
-    return ret_val;
+    return invalid_mask;
+}
+
+/**
+ * @brief
+ * Encodes a full block of NUCLEOTIDE_BLOCK_SIZE characters
+ * Upper-cases the characters by clearing bit 5, compares them against A, C, G and T in parallel,
+ * builds the 2-bit codes from the comparison results and collects the non-ACGT positions with a movemask
+ *
+ * @param chars pointer to the characters to be encoded
+ * @param codes output array of 2-bit nucleotide codes (0 at non-ACGT positions)
+ * @return bitmask with bit i set iff chars[i] is not ACGT
+ */
+inline uint32_t encode_nucleotide_block(const char *chars, uint8_t *codes)
+{
+#if defined(__AVX2__)
+    const __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(chars));
+    const __m256i upper = _mm256_and_si256(raw, _mm256_set1_epi8((char)0xDF));
+    const __m256i is_a = _mm256_cmpeq_epi8(upper, _mm256_set1_epi8('A'));
+    const __m256i is_c = _mm256_cmpeq_epi8(upper, _mm256_set1_epi8('C'));
+    const __m256i is_g = _mm256_cmpeq_epi8(upper, _mm256_set1_epi8('G'));
+    const __m256i is_t = _mm256_cmpeq_epi8(upper, _mm256_set1_epi8('T'));
+    const __m256i bits = _mm256_or_si256(
+        _mm256_and_si256(is_c, _mm256_set1_epi8(1)),
+        _mm256_or_si256(
+            _mm256_and_si256(is_g, _mm256_set1_epi8(2)),
+            _mm256_and_si256(is_t, _mm256_set1_epi8(3))));
+    const __m256i valid = _mm256_or_si256(_mm256_or_si256(is_a, is_c), _mm256_or_si256(is_g, is_t));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(codes), bits);
+    return ~(uint32_t)_mm256_movemask_epi8(valid);
+#elif defined(__SSE2__)
+    const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i *>(chars));
+    const __m128i upper = _mm_and_si128(raw, _mm_set1_epi8((char)0xDF));
+    const __m128i is_a = _mm_cmpeq_epi8(upper, _mm_set1_epi8('A'));
+    const __m128i is_c = _mm_cmpeq_epi8(upper, _mm_set1_epi8('C'));
+    const __m128i is_g = _mm_cmpeq_epi8(upper, _mm_set1_epi8('G'));
+    const __m128i is_t = _mm_cmpeq_epi8(upper, _mm_set1_epi8('T'));
+    const __m128i bits = _mm_or_si128(
+        _mm_and_si128(is_c, _mm_set1_epi8(1)),
+        _mm_or_si128(
+            _mm_and_si128(is_g, _mm_set1_epi8(2)),
+            _mm_and_si128(is_t, _mm_set1_epi8(3))));
+    const __m128i valid = _mm_or_si128(_mm_or_si128(is_a, is_c), _mm_or_si128(is_g, is_t));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(codes), bits);
+    return (~(uint32_t)_mm_movemask_epi8(valid)) & 0xFFFF;
+#else
+    return encode_nucleotide_block_scalar(chars, NUCLEOTIDE_BLOCK_SIZE, codes);
+#endif
 }
 
 /**
@@ -134,48 +209,116 @@ std::vector<std::string> strings_from_fasta(const char fasta_filename[])
 
 /**
  * @brief
- * Helper function to add nucleotide strings
- * Takes in a reference to a vector of ACGT strings and the current string to be processed
- * Mutates the vector of ACGT strings by appending new ACGT strings
+ * Appends a span of nucleotide characters to the ACGT string currently being built
+ * The current ACGT string is cut at every non-ACGT character
  *
- * @param return_strings List of ACGT strings to be mutated
- * @param raw_string String of nucleotide characters to be processed
+ * @param span_begin pointer to the first character of the span
+ * @param span_end pointer past the last character of the span
  */
-void add_nucleotide_strings(
-    std::vector<acgt_string> &return_strings,
-    const std::string &raw_string)
+void nucleotide_string_encoder::add_span(const char *span_begin, const char *span_end)
 {
-    // ACGT string storing the current nucleotides
-    acgt_string cur_nucleotides;
-
-    // Get the raw string length
-    int raw_string_length = raw_string.length();
-
-    // For each index of the raw string, we convert that
-    for (int idx = 0; idx < raw_string_length; ++idx)
+    uint8_t codes[NUCLEOTIDE_BLOCK_SIZE];
+    const char *ptr = span_begin;
+    while (ptr != span_end)
     {
-        uint8_t nucleotide_bits = nucleotide_to_bits(raw_string[idx]);
+        // Encode a whole block at a time, finishing with a scalar block for the tail of the span
+        const int block_length = std::min<ptrdiff_t>(span_end - ptr, NUCLEOTIDE_BLOCK_SIZE);
+        uint32_t invalid_mask = (block_length == NUCLEOTIDE_BLOCK_SIZE)
+                                    ? encode_nucleotide_block(ptr, codes)
+                                    : encode_nucleotide_block_scalar(ptr, block_length, codes);
 
-        // If the nucleotide character is not ACGT, cut the ACGT string here
-        if (nucleotide_bits & 0x4)
+        // Append each run of ACGT characters, cutting the ACGT string at every non-ACGT character
+        int run_start = 0;
+        while (invalid_mask)
         {
-            if (!cur_nucleotides.empty())
-            {
-                return_strings.push_back(cur_nucleotides);
-            }
-            cur_nucleotides.clear();
-        }
-        // Otherwise append the new nucleotide to the current vector
-        else
-        {
-            cur_nucleotides.push_back(nucleotide_bits);
+            int cut = std::countr_zero(invalid_mask);
+            cur_nucleotides.append_codes(codes + run_start, cut - run_start);
+            end_string();
+            run_start = cut + 1;
+            invalid_mask &= invalid_mask - 1;
         }
+        cur_nucleotides.append_codes(codes + run_start, block_length - run_start);
+
+        ptr += block_length;
     }
-    // If there is still an ACGT string left, add this string as well
+}
+
+/**
+ * @brief
+ * Packs 8 nucleotide codes (one per byte) into 16 bits, 2 bits per nucleotide
+ * Each step halves the number of lanes by merging each odd lane into the even lane below it
+ *
+ * @param codes pointer to 8 2-bit nucleotide codes
+ * @return the 8 nucleotides packed into the lowest 16 bits
+ */
+inline uint64_t pack_8_nucleotide_codes(const uint8_t *codes)
+{
+    uint64_t x;
+    memcpy(&x, codes, sizeof(x));
+    x = (x | (x >> 6)) & 0x000F000F000F000FULL;
+    x = (x | (x >> 12)) & 0x000000FF000000FFULL;
+    x = (x | (x >> 24)) & 0x000000000000FFFFULL;
+    return x;
+}
+
+/**
+ * @brief
+ * Appends a list of 2-bit nucleotide codes to the packed string, 8 nucleotides at a time
+ *
+ * @param codes pointer to the nucleotide codes, one per byte
+ * @param num_codes number of codes to be appended
+ */
+void acgt_string::append_codes(const uint8_t *codes, const size_t num_codes)
+{
+    words.resize((length + num_codes + 31) / 32, 0);
+
+    size_t idx = 0;
+    for (; idx + 8 <= num_codes; idx += 8)
+    {
+        // A group of 8 nucleotides is 16 bits, so it spills into the next word at most once
+        uint64_t packed = pack_8_nucleotide_codes(codes + idx);
+        size_t bit_offset = 2 * (length % 32);
+        words[length / 32] |= packed << bit_offset;
+        if (bit_offset > 48)
+            words[length / 32 + 1] |= packed >> (64 - bit_offset);
+        length += 8;
+    }
+    for (; idx < num_codes; ++idx)
+    {
+        words[length / 32] |= (uint64_t)codes[idx] << (2 * (length % 32));
+        ++length;
+    }
+}
+
+/**
+ * @brief
+ * Ends the ACGT string currently being built, appending it to return_strings if it is non-empty
+ */
+void nucleotide_string_encoder::end_string()
+{
     if (!cur_nucleotides.empty())
     {
-        return_strings.push_back(cur_nucleotides);
+        return_strings.push_back(std::move(cur_nucleotides));
     }
+    cur_nucleotides.clear();
+}
+
+/**
+ * @brief
+ * Helper function to add nucleotide strings
+ * Takes in a reference to a vector of ACGT strings and the current string to be processed
+ * Mutates the vector of ACGT strings by appending new ACGT strings
+ *
+ * @param return_strings List of ACGT strings to be mutated
+ * @param raw_string String of nucleotide characters to be processed
+ */
+void add_nucleotide_strings(
+    std::vector<acgt_string> &return_strings,
+    const std::string &raw_string)
+{
+    nucleotide_string_encoder encoder(return_strings);
+    encoder.add_span(raw_string.data(), raw_string.data() + raw_string.length());
+    encoder.end_string();
 }
 
 /**
@@ -197,15 +340,137 @@ std::vector<acgt_string> cut_nucleotide_strings(const std::vector<std::string> &
     return return_strings;
 }
 
+/**
+ * @brief
+ * Helper function to compute the nucleotide strings from the raw bytes of a fasta file
+ * Walks the lines in place and feeds each sequence line straight to the encoder, so no string is built per record
+ * Follows the same rules as strings_from_fasta followed by cut_nucleotide_strings:
+ * - Records are separated by header lines and empty lines
+ * - A header line with an empty name does not start a record
+ * - A sequence line containing a space discards the whole record read so far
+ *
+ * @param fasta_begin pointer to the first byte of the fasta data
+ * @param fasta_end pointer past the last byte of the fasta data
+ * @return List of ACGT strings in the fasta data
+ */
+std::vector<acgt_string> nucleotide_strings_from_fasta_bytes(const char *fasta_begin, const char *fasta_end)
+{
+    std::vector<acgt_string> return_strings;
+    nucleotide_string_encoder encoder(return_strings);
+
+    // Whether we are inside a named record, where the ACGT strings of that record begin, and its name
+    bool in_record = false;
+    size_t record_start = 0;
+    const char *name_begin = fasta_begin, *name_end = fasta_begin;
+
+    const char *line_begin = fasta_begin;
+    while (line_begin < fasta_end)
+    {
+        const char *line_end = static_cast<const char *>(memchr(line_begin, '\n', fasta_end - line_begin));
+        if (line_end == nullptr)
+            line_end = fasta_end;
+
+        if (line_begin == line_end || *line_begin == '>')
+        {
+            if (in_record)
+            {
+                encoder.end_string();
+                if (LOGGING && line_begin != line_end)
+                    std::clog << INFO_LOG << "Read " << std::string(name_begin, name_end) << std::endl;
+            }
+            if (line_begin != line_end)
+            {
+                name_begin = line_begin + 1;
+                name_end = line_end;
+                in_record = (name_begin != name_end);
+            }
+            record_start = return_strings.size();
+        }
+        else if (in_record)
+        {
+            if (memchr(line_begin, ' ', line_end - line_begin) != nullptr)
+            {
+                encoder.discard_string();
+                return_strings.resize(record_start);
+                in_record = false;
+            }
+            else
+            {
+                encoder.add_span(line_begin, line_end);
+            }
+        }
+        line_begin = line_end + 1;
+    }
+    if (in_record)
+    {
+        encoder.end_string();
+        if (LOGGING)
+            std::clog << INFO_LOG << "Read " << std::string(name_begin, name_end) << std::endl;
+    }
+
+    return return_strings;
+}
+
 /**
  * @brief
  * Helper function to compute the nucleotide strings from a fasta file given the name of the file
- * Composes the above helper functions together for convenience
+ * Maps the file into memory and encodes it in a single pass over the mapped bytes
  *
  * @param fasta_filename Filename of the fasta file
  * @return List of ACGT strings in file
  */
 std::vector<acgt_string> nucleotide_strings_from_fasta_file(const char fasta_filename[])
 {
-    return cut_nucleotide_strings(strings_from_fasta(fasta_filename));
-}
\ No newline at end of file
+    mapped_file fasta_file(fasta_filename);
+
+    // If unable to open the file, print and error and exit
+    if (!fasta_file.good())
+    {
+        std::cerr << "Unable to open " << fasta_filename << ". \n Exiting..." << std::endl;
+        exit(1);
+    }
+
+    if (LOGGING)
+        std::clog << INFO_LOG << "Mapped " << fasta_file.size << " bytes from file " << fasta_filename << std::endl;
+
+    return nucleotide_strings_from_fasta_bytes(fasta_file.begin(), fasta_file.end());
+}
+
+
+/**
+ * @brief
+ * Splits a list of ACGT strings into chunks of about chunk_length kmer windows each
+ * Chunks never cross the boundary between two strings, and consecutive chunks of the same string
+ * overlap by window_length - 1 nucleotides, so every window of every string lies in exactly one chunk
+ * Strings shorter than the window have no windows and get no chunks
+ *
+ * @param nucleotide_strings list of ACGT strings
+ * @param window_length window size of the kmer
+ * @param chunk_length number of windows in each chunk (the last chunk of each string may have fewer)
+ * @return list of chunks
+ */
+std::vector<nucleotide_string_chunk> split_nucleotide_strings(
+    const std::vector<acgt_string> &nucleotide_strings,
+    const int window_length,
+    const size_t chunk_length)
+{
+    if (chunk_length == 0)
+        throw std::runtime_error("Chunk length must be positive");
+
+    std::vector<nucleotide_string_chunk> chunks;
+    for (size_t string_idx = 0; string_idx < nucleotide_strings.size(); ++string_idx)
+    {
+        const size_t string_length = nucleotide_strings[string_idx].size();
+        if (string_length < (size_t)window_length)
+            continue;
+
+        // Windows start at 0, ..., string_length - window_length
+        const size_t num_windows = string_length - window_length + 1;
+        for (size_t first_window = 0; first_window < num_windows; first_window += chunk_length)
+        {
+            const size_t chunk_windows = std::min(chunk_length, num_windows - first_window);
+            chunks.push_back({string_idx, first_window, first_window + chunk_windows + window_length - 1});
+        }
+    }
+    return chunks;
+}
@@ -8,16 +8,164 @@
  * @copyright Copyright (c) 2024
  *
  */
+#ifndef FASTA_PROCESSING_HPP
+#define FASTA_PROCESSING_HPP
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include "logging.hpp"
 
-typedef std::vector<uint8_t> acgt_string;
+/**
+ * @brief
+ * String of ACGT nucleotides packed 2 bits per nucleotide (32 nucleotides per 64-bit word)
+ * Nucleotide i is stored in bits 2(i % 32) and 2(i % 32) + 1 of words[i / 32], using the 2-bit words from nucleotide_to_bits
+ * Unused bits of the last word are always 0
+ *
+ * @param words packed nucleotides
+ * @param length number of nucleotides in the string
+ */
+struct acgt_string
+{
+    std::vector<uint64_t> words;
+    size_t length = 0;
+
+    inline size_t size() const
+    {
+        return length;
+    }
+
+    inline bool empty() const
+    {
+        return length == 0;
+    }
+
+    inline void clear()
+    {
+        words.clear();
+        length = 0;
+    }
+
+    /**
+     * @brief
+     * Returns the 2-bit word of the nucleotide at index idx
+     */
+    inline uint8_t operator[](const size_t idx) const
+    {
+        return (words[idx / 32] >> (2 * (idx % 32))) & 0x3;
+    }
+
+    /**
+     * @brief
+     * Appends a single nucleotide given as a 2-bit word
+     */
+    inline void push_back(const uint8_t nucleotide_bits)
+    {
+        if (length % 32 == 0)
+            words.push_back(0);
+        words.back() |= (uint64_t)nucleotide_bits << (2 * (length % 32));
+        ++length;
+    }
+
+    void append_codes(const uint8_t *codes, const size_t num_codes);
+};
+
+/**
+ * @brief
+ * Sequential reader over an acgt_string that loads a whole 64-bit word at a time
+ * and hands out the nucleotides in it one by one
+ *
+ * @param word_ptr pointer to the next word to be loaded
+ * @param cur_word remaining nucleotides of the current word, lowest bits first
+ * @param remaining_in_word number of nucleotides left in cur_word
+ */
+struct acgt_string_reader
+{
+    const uint64_t *word_ptr;
+    uint64_t cur_word = 0;
+    int remaining_in_word = 0;
+
+    explicit acgt_string_reader(const acgt_string &s, const size_t start_idx = 0)
+        : word_ptr(s.words.data() + start_idx / 32)
+    {
+        if (start_idx % 32 != 0)
+        {
+            cur_word = *word_ptr++ >> (2 * (start_idx % 32));
+            remaining_in_word = 32 - start_idx % 32;
+        }
+    }
+
+    /**
+     * @brief
+     * Returns the 2-bit word of the next nucleotide in the string
+     */
+    inline uint8_t next()
+    {
+        if (remaining_in_word == 0)
+        {
+            cur_word = *word_ptr++;
+            remaining_in_word = 32;
+        }
+        uint8_t nucleotide_bits = cur_word & 0x3;
+        cur_word >>= 2;
+        --remaining_in_word;
+        return nucleotide_bits;
+    }
+};
+
+/**
+ * @brief
+ * Streaming encoder from nucleotide characters to ACGT strings
+ * Characters can be fed in as many spans as needed (e.g. one per line of a fasta record),
+ * the current ACGT string is cut at every non-ACGT character and only ends when end_string is called
+ *
+ * @param return_strings list of ACGT strings that completed strings are appended to
+ * @param cur_nucleotides ACGT string currently being built
+ */
+struct nucleotide_string_encoder
+{
+    std::vector<acgt_string> &return_strings;
+    acgt_string cur_nucleotides;
+
+    explicit nucleotide_string_encoder(std::vector<acgt_string> &strings) : return_strings(strings) {}
+
+    void add_span(const char *span_begin, const char *span_end);
+    void end_string();
+
+    /**
+     * @brief
+     * Throws away the ACGT string currently being built
+     */
+    inline void discard_string()
+    {
+        cur_nucleotides.clear();
+    }
+};
 
 std::vector<std::string> strings_from_fasta(const char fasta_filename[]);
 void add_nucleotide_strings(std::vector<acgt_string> &return_strings, const std::string &raw_string);
 std::vector<acgt_string> cut_nucleotide_strings(const std::vector<std::string> &raw_strings);
+std::vector<acgt_string> nucleotide_strings_from_fasta_bytes(const char *fasta_begin, const char *fasta_end);
 std::vector<acgt_string> nucleotide_strings_from_fasta_file(const char fasta_filename[]);
+
+/**
+ * @brief
+ * Range [start_idx, end_idx) of nucleotides in one of a list of ACGT strings, used to split the work on a file between workers
+ *
+ * @param string_idx index of the ACGT string in the list
+ * @param start_idx index of the first nucleotide in the range
+ * @param end_idx index one past the last nucleotide in the range
+ */
+struct nucleotide_string_chunk
+{
+    size_t string_idx;
+    size_t start_idx;
+    size_t end_idx;
+};
+std::vector<nucleotide_string_chunk> split_nucleotide_strings(
+    const std::vector<acgt_string> &nucleotide_strings,
+    const int window_length,
+    const size_t chunk_length);
+#endif
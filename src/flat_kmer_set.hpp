@@ -0,0 +1,371 @@
+/**
+ * @file flat_kmer_set.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains flat_kmer_set, an open-addressing hash set of compacted kmer codes
+ * with the same interface as kmer_set, for exact or large kmer sets
+ *
+ * The layout follows the Swiss table: slots are split into groups of 16, and every slot has a control byte
+ * holding either EMPTY_SLOT or the low 7 bits of the hash of its code
+ * A lookup compares the control bytes of a whole group with one SSE2 comparison,
+ * so only the slots whose 7 hash bits match are compared in full
+ */
+#ifndef FLAT_KMER_SET_HPP
+#define FLAT_KMER_SET_HPP
+#include "kmer.hpp"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief
+ * Default maximum fraction of slots in use before the table grows
+ */
+constexpr double DEFAULT_FLAT_KMER_SET_LOAD_FACTOR = 0.875;
+
+/**
+ * @brief
+ * Seed of the hash used to place codes in the table
+ * It differs from the FracMinHash seeds, since sketched codes all have small FracMinHash hashes
+ */
+constexpr uint64_t FLAT_KMER_SET_HASH_SEED = 0x9E3779B97F4A7C15ULL;
+
+/**
+ * @brief
+ * Open-addressing hash set of compacted kmer codes, usable in place of kmer_set
+ * Only the compacted code (masked_bits) of every kmer is stored, so all kmers in a set must share the same mask,
+ * and a set of kmers with k <= 32 takes 8 bytes (plus one control byte) per slot with code_t = uint64_t
+ * Kmers can only be inserted, except for retain_if, which rebuilds the table
+ *
+ * @tparam code_t kmer word type of the stored codes, must hold 2k bits
+ * @param max_load_factor maximum fraction of slots in use, in (0, 1)
+ * @param num_kmers number of kmers in the set
+ * @param num_groups number of groups of GROUP_SIZE slots, a power of two
+ * @param control_bytes control byte of every slot
+ * @param slots code held in every slot
+ */
+template <typename code_t = kmer_code>
+struct flat_kmer_set
+{
+    static constexpr size_t GROUP_SIZE = 16;
+    static constexpr int8_t EMPTY_SLOT = -128;
+
+    double max_load_factor;
+    size_t num_kmers = 0;
+    size_t num_groups = 1;
+    std::vector<int8_t> control_bytes;
+    std::vector<code_t> slots;
+
+    explicit flat_kmer_set(const double max_load_factor = DEFAULT_FLAT_KMER_SET_LOAD_FACTOR)
+        : max_load_factor(max_load_factor),
+          control_bytes(GROUP_SIZE, EMPTY_SLOT),
+          slots(GROUP_SIZE)
+    {
+        // A full table would leave no empty slot to end a lookup
+        if (!(max_load_factor > 0 && max_load_factor < 1))
+            throw std::runtime_error("Load factor of flat_kmer_set must be between 0 and 1");
+    }
+
+    /**
+     * @brief
+     * Helper function for computing the size of the kmer set
+     *
+     * @return int
+     */
+    inline int kmer_set_size() const
+    {
+        return num_kmers;
+    }
+
+    /**
+     * @brief
+     * Grows the table so that num_kmers_expected kmers fit without rehashing
+     *
+     * @param num_kmers_expected number of kmers expected in the set
+     */
+    void reserve(const size_t num_kmers_expected)
+    {
+        size_t new_num_groups = num_groups;
+        while (num_kmers_expected > max_size(new_num_groups))
+            new_num_groups *= 2;
+        if (new_num_groups != num_groups)
+            rehash(new_num_groups);
+    }
+
+    /**
+     * @brief
+     * Inserts a compacted kmer code
+     *
+     * @param code compacted kmer code
+     * @return true if the code was not already in the set
+     */
+    bool insert_code(const code_t &code)
+    {
+        if (num_kmers + 1 > max_size(num_groups))
+            rehash(num_groups * 2);
+
+        const uint64_t hash = code_hash(code);
+        const int8_t hash_bits = hash_control_byte(hash);
+        size_t group = hash_group(hash);
+        for (size_t step = 1;; ++step)
+        {
+            const int8_t *group_control = control_bytes.data() + group * GROUP_SIZE;
+            for (uint32_t matches = match_control_byte(group_control, hash_bits); matches != 0; matches &= matches - 1)
+            {
+                if (slots[group * GROUP_SIZE + std::countr_zero(matches)] == code)
+                    return false;
+            }
+
+            // Kmers are never erased, so the first empty slot in the probe sequence ends it
+            const uint32_t empty_slots = match_control_byte(group_control, EMPTY_SLOT);
+            if (empty_slots != 0)
+            {
+                const size_t slot = group * GROUP_SIZE + std::countr_zero(empty_slots);
+                control_bytes[slot] = hash_bits;
+                slots[slot] = code;
+                ++num_kmers;
+                return true;
+            }
+            group = (group + step) & (num_groups - 1);
+        }
+    }
+
+    /**
+     * @brief
+     * Checks whether a compacted kmer code is in the set
+     *
+     * @param code compacted kmer code
+     * @return true if the code is in the set
+     */
+    bool contains_code(const code_t &code) const
+    {
+        const uint64_t hash = code_hash(code);
+        const int8_t hash_bits = hash_control_byte(hash);
+        size_t group = hash_group(hash);
+        for (size_t step = 1;; ++step)
+        {
+            const int8_t *group_control = control_bytes.data() + group * GROUP_SIZE;
+            for (uint32_t matches = match_control_byte(group_control, hash_bits); matches != 0; matches &= matches - 1)
+            {
+                if (slots[group * GROUP_SIZE + std::countr_zero(matches)] == code)
+                    return true;
+            }
+            if (match_control_byte(group_control, EMPTY_SLOT) != 0)
+                return false;
+            group = (group + step) & (num_groups - 1);
+        }
+    }
+
+    /**
+     * @brief
+     * Helper function for inserting a single kmer
+     *
+     * @param k kmer to be inserted
+     */
+    inline void insert_kmer(const kmer &k)
+    {
+        if (DEBUG)
+            std::cout << "Inserting kmer " << k.masked_bits << std::endl;
+        insert_code(convert_kmer_word<code_t>(k.masked_bits));
+    }
+
+    /**
+     * @brief
+     * Helper function for inserting kmers
+     *
+     * @param kmers list of kmers
+     */
+    void insert_kmers(const std::vector<kmer> &kmers)
+    {
+        reserve(num_kmers + kmers.size());
+        for (const kmer &k : kmers)
+        {
+            insert_kmer(k);
+        }
+    }
+
+    inline bool contains_kmer(const kmer &k) const
+    {
+        return contains_code(convert_kmer_word<code_t>(k.masked_bits));
+    }
+
+    /**
+     * @brief
+     * Calls f on every code in the set, in table order
+     *
+     * @param f callable taking a const code_t &
+     */
+    template <typename code_callable>
+    void for_each_code(code_callable &&f) const
+    {
+        for (size_t slot = 0; slot < slots.size(); ++slot)
+        {
+            if (control_bytes[slot] != EMPTY_SLOT)
+                f(slots[slot]);
+        }
+    }
+
+    /**
+     * @brief
+     * Keeps only the codes satisfying a predicate, rebuilding the table
+     *
+     * @param keep callable taking a const code_t & and returning whether to keep it
+     */
+    template <typename code_predicate>
+    void retain_if(code_predicate &&keep)
+    {
+        flat_kmer_set retained(max_load_factor);
+        for_each_code(
+            [&](const code_t &code)
+            {
+                if (keep(code))
+                    retained.insert_code(code);
+            });
+        *this = std::move(retained);
+    }
+
+private:
+    inline size_t max_size(const size_t groups) const
+    {
+        return (size_t)(groups * GROUP_SIZE * max_load_factor);
+    }
+
+    static inline uint64_t code_hash(const code_t &code)
+    {
+        return kmer_word_hash(code, FLAT_KMER_SET_HASH_SEED);
+    }
+
+    // The low 7 bits of the hash go into the control byte, and the rest pick the first group to probe
+    static inline int8_t hash_control_byte(const uint64_t hash)
+    {
+        return (int8_t)(hash & 0x7F);
+    }
+
+    inline size_t hash_group(const uint64_t hash) const
+    {
+        return (hash >> 7) & (num_groups - 1);
+    }
+
+    /**
+     * @brief
+     * Returns a bitmask of the slots in a group whose control byte equals value
+     */
+    static inline uint32_t match_control_byte(const int8_t *group_control, const int8_t value)
+    {
+#if defined(__SSE2__)
+        const __m128i control = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group_control));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(value)));
+#else
+        uint32_t matches = 0;
+        for (size_t i = 0; i < GROUP_SIZE; ++i)
+            matches |= (uint32_t)(group_control[i] == value) << i;
+        return matches;
+#endif
+    }
+
+    /**
+     * @brief
+     * Moves every code into a table with the given number of groups
+     */
+    void rehash(const size_t new_num_groups)
+    {
+        const std::vector<int8_t> old_control_bytes = std::exchange(control_bytes, std::vector<int8_t>(new_num_groups * GROUP_SIZE, EMPTY_SLOT));
+        const std::vector<code_t> old_slots = std::exchange(slots, std::vector<code_t>(new_num_groups * GROUP_SIZE));
+        num_groups = new_num_groups;
+
+        for (size_t slot = 0; slot < old_slots.size(); ++slot)
+        {
+            if (old_control_bytes[slot] == EMPTY_SLOT)
+                continue;
+
+            // The codes are distinct, so each one goes into the first empty slot of its probe sequence
+            const uint64_t hash = code_hash(old_slots[slot]);
+            size_t group = hash_group(hash);
+            for (size_t step = 1;; ++step)
+            {
+                const uint32_t empty_slots = match_control_byte(control_bytes.data() + group * GROUP_SIZE, EMPTY_SLOT);
+                if (empty_slots != 0)
+                {
+                    const size_t new_slot = group * GROUP_SIZE + std::countr_zero(empty_slots);
+                    control_bytes[new_slot] = old_control_bytes[slot];
+                    slots[new_slot] = old_slots[slot];
+                    break;
+                }
+                group = (group + step) & (num_groups - 1);
+            }
+        }
+    }
+};
+
+/**
+ * @brief
+ * Helper function to compute the number of kmers in the intersection of two flat kmer sets
+ * Iterates over the smaller set and looks up its codes in the larger one
+ *
+ * @param fs1 flat_kmer_set containing the first set of kmers
+ * @param fs2 flat_kmer_set containing the second set of kmers
+ * @return number of kmers in the intersection of the two kmer sets
+ */
+template <typename code_t>
+int flat_kmer_set_intersection(const flat_kmer_set<code_t> &fs1, const flat_kmer_set<code_t> &fs2)
+{
+    if (fs1.kmer_set_size() < fs2.kmer_set_size())
+        return flat_kmer_set_intersection(fs2, fs1);
+
+    int inters = 0;
+    fs2.for_each_code(
+        [&](const code_t &code)
+        {
+            inters += fs1.contains_code(code);
+        });
+    return inters;
+}
+
+/**
+ * @brief
+ * Helper function to compute the union of a list of flat kmer sets
+ * The codes of the other sets are inserted into the largest set, so the list is left in a valid but unspecified state
+ *
+ * @param flat_kmer_sets list of flat kmer sets
+ * @return flat_kmer_set containing every kmer in the list
+ */
+template <typename code_t>
+flat_kmer_set<code_t> merge_sketches(std::vector<flat_kmer_set<code_t>> &flat_kmer_sets)
+{
+    if (flat_kmer_sets.empty())
+        return flat_kmer_set<code_t>();
+
+    auto largest = std::max_element(
+        flat_kmer_sets.begin(),
+        flat_kmer_sets.end(),
+        [](const flat_kmer_set<code_t> &a, const flat_kmer_set<code_t> &b)
+        { return a.kmer_set_size() < b.kmer_set_size(); });
+    flat_kmer_set<code_t> merged = std::move(*largest);
+
+    // The largest set has been moved from, so it is skipped explicitly rather than relying on it being left empty
+    size_t total_size = merged.kmer_set_size();
+    for (auto it = flat_kmer_sets.begin(); it != flat_kmer_sets.end(); ++it)
+    {
+        if (it != largest)
+            total_size += it->kmer_set_size();
+    }
+    merged.reserve(total_size);
+
+    for (auto it = flat_kmer_sets.begin(); it != flat_kmer_sets.end(); ++it)
+    {
+        if (it == largest)
+            continue;
+        it->for_each_code(
+            [&](const code_t &code)
+            {
+                merged.insert_code(code);
+            });
+    }
+    return merged;
+}
+
+#endif
@@ -0,0 +1,197 @@
+/**
+ * @file hash_sketch.cpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This file contains the intersection functions for sorted hash-array sketches
+ */
+#include "kmer.hpp"
+#include "hash_sketch.hpp"
+
+/**
+ * @brief
+ * When one array is at least this many times larger than the other, the intersection gallops through the larger array
+ * instead of merging, which costs O(small * log(large / small)) instead of O(small + large)
+ */
+constexpr size_t GALLOPING_SIZE_RATIO = 16;
+
+/**
+ * @brief
+ * Intersection size of two sorted arrays of distinct hashes by merging them
+ * The loop has no data-dependent branches, since mispredicted branches dominate a plain merge
+ */
+inline size_t merge_intersection(
+    const uint64_t *hashes_1,
+    const size_t num_hashes_1,
+    const uint64_t *hashes_2,
+    const size_t num_hashes_2)
+{
+    size_t inters = 0;
+    size_t i = 0, j = 0;
+    while (i < num_hashes_1 && j < num_hashes_2)
+    {
+        const uint64_t h1 = hashes_1[i];
+        const uint64_t h2 = hashes_2[j];
+        inters += (h1 == h2);
+        i += (h1 <= h2);
+        j += (h2 <= h1);
+    }
+    return inters;
+}
+
+/**
+ * @brief
+ * Intersection size of two sorted arrays of distinct hashes, looking up every hash of the small array in the large array
+ * Each lookup is an exponential search from the position of the previous match, followed by a binary search
+ */
+inline size_t galloping_intersection(
+    const uint64_t *small_hashes,
+    const size_t num_small_hashes,
+    const uint64_t *large_hashes,
+    const size_t num_large_hashes)
+{
+    size_t inters = 0;
+    const uint64_t *lo = large_hashes;
+    const uint64_t *const end = large_hashes + num_large_hashes;
+    for (size_t i = 0; i < num_small_hashes && lo != end; ++i)
+    {
+        const uint64_t h = small_hashes[i];
+
+        // Find a bound with lo[bound] >= h, doubling the step each time
+        size_t bound = 1;
+        while (bound < (size_t)(end - lo) && lo[bound] < h)
+            bound <<= 1;
+
+        // lo[bound / 2] < h (or bound / 2 == 0), so the first hash >= h is in [lo + bound / 2, lo + bound]
+        lo = std::lower_bound(lo + bound / 2, std::min(lo + bound + 1, end), h);
+        if (lo != end && *lo == h)
+        {
+            ++inters;
+            ++lo;
+        }
+    }
+    return inters;
+}
+
+/**
+ * @brief
+ * Helper function to compute the number of hashes in the intersection of two sorted arrays of distinct hashes
+ * Takes raw ranges so that it can also be used on sketches that are not held in a hash_sketch
+ *
+ * @param hashes_1 first sorted array of hashes
+ * @param num_hashes_1 number of hashes in the first array
+ * @param hashes_2 second sorted array of hashes
+ * @param num_hashes_2 number of hashes in the second array
+ * @return number of hashes in both arrays
+ */
+size_t sorted_hash_intersection(
+    const uint64_t *hashes_1,
+    const size_t num_hashes_1,
+    const uint64_t *hashes_2,
+    const size_t num_hashes_2)
+{
+    // Ensure that the second array is the larger of the two
+    if (num_hashes_1 > num_hashes_2)
+        return sorted_hash_intersection(hashes_2, num_hashes_2, hashes_1, num_hashes_1);
+
+    if (num_hashes_1 * GALLOPING_SIZE_RATIO < num_hashes_2)
+        return galloping_intersection(hashes_1, num_hashes_1, hashes_2, num_hashes_2);
+    return merge_intersection(hashes_1, num_hashes_1, hashes_2, num_hashes_2);
+}
+
+/**
+ * @brief
+ * Helper function to compute the number of hashes in the intersection of two hash sketches
+ *
+ * @param hs1 hash_sketch containing the first set of hashes
+ * @param hs2 hash_sketch containing the second set of hashes
+ * @return number of hashes in the intersection of the two sketches
+ */
+int hash_sketch_intersection(const hash_sketch &hs1, const hash_sketch &hs2)
+{
+    return sorted_hash_intersection(
+        hs1.hashes.data(),
+        hs1.hashes.size(),
+        hs2.hashes.data(),
+        hs2.hashes.size());
+}
+
+/**
+ * @brief
+ * Helper function to compute the union of a list of hash sketches
+ * The hashes are concatenated and sorted once, which costs O(n log n) however many sketches there are
+ *
+ * @param hash_sketches list of hash sketches
+ * @return hash_sketch containing every hash in the list
+ */
+hash_sketch merge_sketches(std::vector<hash_sketch> &hash_sketches)
+{
+    size_t total_size = 0;
+    for (const hash_sketch &hs : hash_sketches)
+        total_size += hs.hashes.size();
+
+    hash_sketch merged;
+    merged.hashes.reserve(total_size);
+    for (const hash_sketch &hs : hash_sketches)
+        merged.hashes.insert(merged.hashes.end(), hs.hashes.begin(), hs.hashes.end());
+    std::sort(merged.hashes.begin(), merged.hashes.end());
+    merged.hashes.erase(std::unique(merged.hashes.begin(), merged.hashes.end()), merged.hashes.end());
+    return merged;
+}
+
+/**
+ * @brief
+ * Helper function to compute hash_sketch intersections for a list of pairs of hash_sketches, computed pairwise
+ *
+ * @param hash_sketches_1 first list of hash_sketch pointers
+ * @param hash_sketches_2 second list of hash_sketch pointers
+ * @return list of ints representing the intersection size of the corresponding pair of sketches
+ */
+std::vector<int> compute_pairwise_hash_sketch_intersections(
+    const std::vector<hash_sketch *> &hash_sketches_1,
+    const std::vector<hash_sketch *> &hash_sketches_2)
+{
+    if (hash_sketches_1.size() != hash_sketches_2.size())
+    {
+        throw std::runtime_error("Lists of hash sketches for intersection computation have different lengths");
+    }
+    std::vector<int> intersection_values(hash_sketches_1.size());
+    for (size_t i = 0; i < hash_sketches_1.size(); ++i)
+    {
+        intersection_values[i] = hash_sketch_intersection(*hash_sketches_1[i], *hash_sketches_2[i]);
+    }
+    return intersection_values;
+}
+
+/**
+ * @brief
+ * Parallel version of compute_pairwise_hash_sketch_intersections using parallel_for
+ *
+ * @param hash_sketches_1 first list of hash_sketch pointers
+ * @param hash_sketches_2 second list of hash_sketch pointers
+ * @return list of ints representing the intersection size of the corresponding pair of sketches
+ */
+std::vector<int> parallel_compute_pairwise_hash_sketch_intersections(
+    const std::vector<hash_sketch *> &hash_sketches_1,
+    const std::vector<hash_sketch *> &hash_sketches_2)
+{
+    if (PARALLEL_DISABLE)
+        return compute_pairwise_hash_sketch_intersections(hash_sketches_1, hash_sketches_2);
+
+    if (hash_sketches_1.size() != hash_sketches_2.size())
+    {
+        throw std::runtime_error("Lists of hash sketches for intersection computation have different lengths");
+    }
+    std::vector<int> intersection_values(hash_sketches_1.size());
+    parallel_for(
+        (size_t)0,
+        hash_sketches_1.size(),
+        [&](const size_t i)
+        {
+            intersection_values[i] = hash_sketch_intersection(*hash_sketches_1[i], *hash_sketches_2[i]);
+        });
+    return intersection_values;
+}
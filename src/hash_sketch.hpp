@@ -0,0 +1,77 @@
+/**
+ * @file hash_sketch.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the sorted hash-array sketch, an alternative to kmer_set
+ * that stores the hashes of the sketched kmers in one contiguous sorted array
+ */
+#ifndef HASH_SKETCH_HPP
+#define HASH_SKETCH_HPP
+#include "stl_includes.hpp"
+
+/**
+ * @brief
+ * Sketch holding the sorted, distinct 64-bit hashes of its kmers
+ * Uses 8 bytes per kmer, and intersections are computed by merging the two arrays
+ *
+ * @param hashes sorted hashes without duplicates
+ */
+struct hash_sketch
+{
+    std::vector<uint64_t> hashes;
+
+    /**
+     * @brief
+     * Helper function for computing the size of the sketch
+     *
+     * @return int
+     */
+    inline int sketch_size() const
+    {
+        return hashes.size();
+    }
+};
+
+/**
+ * @brief
+ * Cuts a buffer of hashes back to its sketch_size smallest distinct hashes, used to maintain bottom-k sketches
+ * Once the buffer holds sketch_size distinct hashes, the threshold is tightened to the largest of them,
+ * so that larger hashes can be rejected before reaching the buffer
+ *
+ * @param hashes buffer of hashes, sorted and without duplicates afterwards
+ * @param sketch_size number of hashes kept
+ * @param threshold acceptance threshold to tighten
+ */
+inline void cut_to_bottom_k(std::vector<uint64_t> &hashes, const size_t sketch_size, uint64_t &threshold)
+{
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    if (hashes.size() >= sketch_size)
+    {
+        hashes.resize(sketch_size);
+        if (sketch_size > 0)
+            threshold = std::min(threshold, hashes.back());
+    }
+}
+
+// Helper functions for computing sketch intersections
+size_t sorted_hash_intersection(
+    const uint64_t *hashes_1,
+    const size_t num_hashes_1,
+    const uint64_t *hashes_2,
+    const size_t num_hashes_2);
+int hash_sketch_intersection(const hash_sketch &hs1, const hash_sketch &hs2);
+// Helper function for computing the union of hash sketches
+hash_sketch merge_sketches(std::vector<hash_sketch> &hash_sketches);
+std::vector<int> compute_pairwise_hash_sketch_intersections(
+    const std::vector<hash_sketch *> &hash_sketches_1,
+    const std::vector<hash_sketch *> &hash_sketches_2);
+std::vector<int> parallel_compute_pairwise_hash_sketch_intersections(
+    const std::vector<hash_sketch *> &hash_sketches_1,
+    const std::vector<hash_sketch *> &hash_sketches_2);
+
+#endif
@@ -8,9 +8,20 @@
  */
 
 #include "kmer.hpp"
+#include "kmer_set.hpp"
+#include "sketch_pipeline.hpp"
+#include "sketch_cache.hpp"
+#include "sketch_sweep.hpp"
 #include "ani_estimator.hpp"
 #include "fasta_processing.hpp"
-#include "generators.hpp"
+#include "all_pairs.hpp"
+#include "sketch_index.hpp"
+#include "sketch_query.hpp"
+#include "multi_resolution_sketch.hpp"
+#include "sketch_file.hpp"
+
+#include <filesystem>
+#include <optional>
 
 /**
  * @brief
@@ -27,31 +38,50 @@ void print_strings(const std::vector<std::string> &string_list)
 
 // Sketching function, example
 frac_min_hash fmh(1);
-inline bool sketching_condition(const kmer &test_kmer)
-{
-    const int c = 200;
-    return (fmh(test_kmer) % c == 0);
-}
+const uint64_t SKETCH_SCALE = 200;
+
+// FracMinHash at scale SKETCH_SCALE, tested on the compacted kmer inside the sliding window
+const frac_min_hash_policy sketching_fmh_policy(fmh, SKETCH_SCALE);
+
+// Default configuration of the query mode, used when neither "--window"/"--kmer" nor sketch files give it
+const int QUERY_WINDOW_SIZE = 21;
+const int QUERY_KMER_SIZE = 21;
+const size_t DEFAULT_QUERY_TOP_K = 10;
 
 /**
  * @brief 
- * Helper function that writes a list of estimated ANI values with the corresponding filenames and masks to a csv
+ * Given the sketches of a number of FASTA files, this function computes an ANI estimate for every ordered pair of files
+ * (self pairs included) and writes them to a .csv file
+ * Each unordered pair is intersected once in the upper triangle, and gives both rows (i, j) and (j, i),
+ * whose containments differ only by the sketch size they are divided by
+ * No list of pairs or of filenames is built: the rows are written as each row of tiles of the triangle is computed,
+ * so they come out grouped by tiles
+ * With use_inverted_index, the intersections come from an inverted index of the sketches (see sketch_index.hpp)
+ * instead, which skips the pairs sharing no hash: their rows, whose estimate is 0, are not written
+ * Otherwise, with min_ani > 0, pairs are first screened on coarser nested sketches (see multi_resolution_sketch.hpp)
+ * Either way, only the rows whose full resolution estimate is at least min_ani are written
  * 
- * @param filenames1 first list of filenames
- * @param filenames2 second list of filenames
- * @param estimated_values list of estimated ANI values
- * @param mask mask used 
- * @param output_filename name of the output csv 
+ * @param hash_sketch_data sketches of the FASTA files, in the order of filenames
+ * @param window_size size of the kmer window
+ * @param mask mask used for the sketches
+ * @param filenames list of the FASTA filenames
+ * @param output_filename .csv file name
+ * @param is_append bool to determine whether to
+ * @param use_inverted_index whether to compare through an inverted index, for large and diverse collections
+ * @param min_ani smallest ANI estimate of the pairs written, or 0 to write every pair
  */
-void write_to_csv(
-    const std::vector<std::string> &filenames1,
-    const std::vector<std::string> &filenames2,
-    const std::vector<double> &estimated_values,
+void compare_all_hash_sketch_pairs_to_csv(
+    std::vector<hash_sketch> &hash_sketch_data,
     const int window_size,
     const kmer_bitset &mask,
+    const std::vector<std::string> &filenames,
     const std::string &output_filename,
-    bool is_append = false)
-{
+    bool is_append,
+    const bool use_inverted_index = false,
+    const double min_ani = 0
+){
+    const int kmer_num_indices = (mask.count() / NUCLEOTIDE_BIT_SIZE); // How many nucleotides are in the kmer
+
     // Open the output file
     std::ofstream output_file;
     if (is_append)
@@ -69,146 +99,321 @@ void write_to_csv(
     if (!is_append)
         output_file << "File 1,File 2,Estimated Value,Window Size,Mask" << std::endl;
 
-    // Write data
-    size_t numEntries = std::min(std::min(filenames1.size(), filenames2.size()), estimated_values.size());
-    for (size_t i = 0; i < numEntries; ++i)
+    auto t_precomparison = std::chrono::high_resolution_clock::now();
+    std::vector<hash_sketch *> hash_sketches_init;
+    for (hash_sketch &hs : hash_sketch_data)
+        hash_sketches_init.push_back(&hs);
+
+    auto write_row = [&](const size_t i, const size_t j, const int intersection)
+    {
+        const double ani_estimate = binomial_estimator(containment(intersection, hash_sketch_data[i].sketch_size()), kmer_num_indices);
+        if (ani_estimate < min_ani)
+            return;
+        output_file << filenames[i] << "," << filenames[j] << "," << ani_estimate << "," << window_size << "," << mask << '\n';
+    };
+
+    auto write_pairs = [&](const std::vector<sketch_pair_intersection> &pairs)
+    {
+        for (const sketch_pair_intersection &pair : pairs)
+        {
+            if (pair.intersection == SCREENED_OUT_INTERSECTION)
+                continue;
+            write_row(pair.i, pair.j, pair.intersection);
+            if (pair.i != pair.j)
+                write_row(pair.j, pair.i, pair.intersection);
+        }
+    };
+
+    if (use_inverted_index)
     {
-        output_file << filenames1[i] << "," << filenames2[i] << "," << estimated_values[i] << "," << window_size << "," << mask << std::endl;
+        const sketch_index index(hash_sketches_init);
+        for_each_indexed_intersection(index, hash_sketches_init, write_pairs, true);
     }
+    else if (min_ani > 0)
+    {
+        // The binomial estimator is ANI = containment ^ (1 / kmer size)
+        const double min_containment = std::pow(min_ani, kmer_num_indices);
+        std::vector<multi_resolution_sketch> multi_resolution_data;
+        for (const hash_sketch &hs : hash_sketch_data)
+            multi_resolution_data.emplace_back(hs, DEFAULT_SCREENING_SCALES);
+        std::vector<multi_resolution_sketch *> multi_resolution_sketches;
+        for (multi_resolution_sketch &ms : multi_resolution_data)
+            multi_resolution_sketches.push_back(&ms);
 
-    // Close the file
-    output_file.close();
+        for_each_upper_triangle_intersection(
+            multi_resolution_sketches,
+            [&](const multi_resolution_sketch &ms1, const multi_resolution_sketch &ms2)
+            { return screened_hash_sketch_intersection(ms1, ms2, min_containment); },
+            write_pairs,
+            true);
+    }
+    else
+    {
+        for_each_upper_triangle_intersection(
+            hash_sketches_init,
+            [](const hash_sketch &hs1, const hash_sketch &hs2)
+            { return hash_sketch_intersection(hs1, hs2); },
+            write_pairs,
+            true);
+    }
+
+    auto t_postcomparison = std::chrono::high_resolution_clock::now();
+    std::cout << "Time taken for comparison = " << std::chrono::duration<double, std::milli>(t_postcomparison - t_precomparison).count() << " ms" << std::endl;
 }
 
 /**
  * @brief 
- * Wrapper for computing adjacent pairwise pairs of kmer_set pointers
+ * Helper function that sketches a list of FASTA files with the example sketching function,
+ * through the sketch cache if one is given, or through the pipeline otherwise
  * 
- * @param kmer_set_pointers 
- * @return std::pair<std::vector<kmer_set *>,std::vector<kmer_set *>> 
+ * @param filenames list of the FASTA filenames
+ * @param window_size size of the kmer window
+ * @param mask mask used for the sketches
+ * @param cache sketch cache reused across runs, or nullptr to sketch every file
+ * @return list of hash_sketches corresponding to the file names given
  */
-std::pair<std::vector<kmer_set *>,std::vector<kmer_set *>> compute_kmer_set_pointer_pairwise(
-    std::vector<kmer_set *> kmer_set_pointers
+std::vector<hash_sketch> hash_sketches_from_fasta_files(
+    const std::vector<std::string> &filenames,
+    const int window_size,
+    const kmer_bitset &mask,
+    sketch_cache *cache
 ){
-    return generate_pairwise_from_vector<kmer_set *>(kmer_set_pointers);
+    if (cache != nullptr)
+    {
+        const sketch_parameters parameters{window_size, mask, fmh.hash_seed, SKETCH_SCALE};
+        return cached_hash_sketches_from_fasta_files(*cache, filenames, parameters, sketching_fmh_policy, fmh);
+    }
+    return pipelined_hash_sketches_from_fasta_files(
+        filenames,
+        mask,
+        window_size,
+        sketching_fmh_policy,
+        fmh);
 }
 
 /**
  * @brief 
- * Wrapper for computing all pairs of kmer_set pointers
+ * Given a number of FASTA files, this function computes an ANI estimate for every pair of files under a list of
+ * (window size, kmer size) configurations, each with a random spaced seed mask, and writes them to a .csv file
+ * Every FASTA file is read and encoded once for all the configurations, and all the results go to one .csv file
+ * 
+ * Every ordered pair of files is compared, see compare_all_hash_sketch_pairs_to_csv
  * 
- * @param kmer_set_pointers 
- * @return std::pair<std::vector<kmer_set *>,std::vector<kmer_set *>> 
+ * @param window_and_kmer_sizes list of (window size, kmer size) configurations
+ * @param filenames list of the FASTA filenames
+ * @param output_filename .csv file name
+ * @param cache sketch cache reused across runs, or nullptr to sketch every file
+ * @param use_inverted_index whether to compare through an inverted index, for large and diverse collections
+ * @param min_ani smallest ANI estimate of the pairs written, or 0 to write every pair
  */
-std::pair<std::vector<kmer_set *>,std::vector<kmer_set *>>  compute_kmer_set_pointer_all_pairs(
-    std::vector<kmer_set *> kmer_set_pointers
+void test_compute_ANI_estimation_sweep(
+    const std::vector<std::pair<int, int>> &window_and_kmer_sizes,
+    const std::vector<std::string> &filenames,
+    const std::string &output_filename,
+    sketch_cache *cache = nullptr,
+    const bool use_inverted_index = false,
+    const double min_ani = 0
 ){
-    return generate_all_pairs_from_vector<kmer_set *>(kmer_set_pointers);
+    std::vector<sketch_parameters> configurations;
+    for (const auto &[window_size, kmer_size] : window_and_kmer_sizes)
+    {
+        configurations.push_back({
+            window_size,
+            generate_random_spaced_seed_mask(window_size, kmer_size),
+            fmh.hash_seed,
+            SKETCH_SCALE});
+    }
+
+    auto t_preprocess_string = std::chrono::high_resolution_clock::now();
+    std::vector<std::vector<hash_sketch>> hash_sketch_data = sweep_hash_sketches_from_fasta_files(
+        filenames,
+        configurations,
+        sketching_fmh_policy,
+        fmh,
+        cache);
+    auto t_postprocess_kmers = std::chrono::high_resolution_clock::now();
+    std::cout << "Time taken for sketching = " << std::chrono::duration<double, std::milli>(t_postprocess_kmers - t_preprocess_string).count() << " ms" << std::endl;
+
+    for (size_t c = 0; c < configurations.size(); ++c)
+    {
+        compare_all_hash_sketch_pairs_to_csv(
+            hash_sketch_data[c],
+            configurations[c].window_length,
+            configurations[c].mask,
+            filenames,
+            output_filename,
+            c > 0,
+            use_inverted_index,
+            min_ani);
+    }
 }
 
 /**
  * @brief 
- * Wrapper for computing adjacent pairwise pairs of strings
+ * Helper function that works out the parameters of the query mode
+ * Sketch files (see sketch_file.hpp) carry their parameters in their header: if any are given, they must all agree,
+ * and the window and kmer sizes given, if any, must match them
+ * Otherwise a random spaced seed mask is drawn for the window and kmer sizes given, or for the default ones
  * 
- * @param kmer_set_pointers 
- * @return std::pair<std::vector<std::string>,std::vector<std::string>> 
+ * @param filenames list of the query and reference files, each a sketch file or a FASTA file
+ * @param window_size size of the kmer window given, or 0 if none was given
+ * @param kmer_size number of characters to be used in the kmer given, or 0 if none was given
+ * @return parameters of the sketches compared
  */
-std::pair<std::vector<std::string>,std::vector<std::string>> compute_strings_pairwise(
-    std::vector<std::string> kmer_set_pointers
+sketch_parameters query_sketch_parameters(
+    const std::vector<std::string> &filenames,
+    const int window_size,
+    const int kmer_size
 ){
-    return generate_pairwise_from_vector<std::string>(kmer_set_pointers);
+    std::optional<sketch_parameters> file_parameters;
+    for (const std::string &filename : filenames)
+    {
+        if (!is_sketch_file(filename.c_str()))
+            continue;
+        const mapped_sketch ms(filename.c_str());
+        if (!ms.good())
+            throw std::runtime_error("Invalid sketch file " + filename);
+        if (file_parameters && !(*file_parameters == ms.parameters))
+            throw std::runtime_error("Sketch file " + filename + " was built with different parameters from the other sketch files");
+        file_parameters = ms.parameters;
+    }
+
+    if (file_parameters)
+    {
+        const int file_kmer_size = file_parameters->mask.count() / NUCLEOTIDE_BIT_SIZE;
+        if ((window_size > 0 && window_size != file_parameters->window_length) || (kmer_size > 0 && kmer_size != file_kmer_size))
+            throw std::runtime_error("Window or kmer size given differs from the one of the sketch files");
+        return *file_parameters;
+    }
+
+    const int window_length = window_size > 0 ? window_size : QUERY_WINDOW_SIZE;
+    const int kmer_length = kmer_size > 0 ? kmer_size : std::min(QUERY_KMER_SIZE, window_length);
+    if (window_length > KMER_BITSET_SIZE / NUCLEOTIDE_BIT_SIZE || kmer_length > window_length)
+        throw std::runtime_error("Kmer size must be at most the window size, which must fit in a kmer_bitset");
+    return {window_length, generate_random_spaced_seed_mask(window_length, kmer_length), fmh.hash_seed, SKETCH_SCALE};
 }
 
 /**
  * @brief 
- * Wrapper for computing all pairs of strings
+ * Helper function that loads the sketches of the query or reference files
+ * Sketch files are loaded as they are, and FASTA files are sketched with the parameters of the sketch files,
+ * through the sketch cache if one is given
  * 
- * @param kmer_set_pointers 
- * @return std::pair<std::vector<std::string>,std::vector<std::string>> 
+ * @param filenames list of files, each a sketch file or a FASTA file
+ * @param parameters parameters of the sketches, see query_sketch_parameters
+ * @param cache sketch cache reused across runs, or nullptr to sketch every FASTA file
+ * @param save_directory directory the sketches of the FASTA files are written to as sketch files, or "" to not write them
+ * @return list of hash_sketches corresponding to the file names given
  */
-std::pair<std::vector<std::string>,std::vector<std::string>> compute_strings_all_pairs(
-    std::vector<std::string> kmer_set_pointers
+std::vector<hash_sketch> query_input_sketches(
+    const std::vector<std::string> &filenames,
+    const sketch_parameters &parameters,
+    sketch_cache *cache,
+    const std::string &save_directory
 ){
-    return generate_all_pairs_from_vector<std::string>(kmer_set_pointers);
+    std::vector<hash_sketch> sketches(filenames.size());
+    std::vector<std::string> fasta_filenames;
+    std::vector<size_t> fasta_indices;
+    for (size_t i = 0; i < filenames.size(); ++i)
+    {
+        if (is_sketch_file(filenames[i].c_str()))
+        {
+            sketches[i] = mapped_sketch(filenames[i].c_str()).to_hash_sketch();
+        }
+        else
+        {
+            fasta_filenames.push_back(filenames[i]);
+            fasta_indices.push_back(i);
+        }
+    }
+    if (fasta_filenames.empty())
+        return sketches;
+
+    // FASTA files can only be sketched with the example sketching function
+    if (parameters.hash_seed != fmh.hash_seed || parameters.scale != SKETCH_SCALE)
+        throw std::runtime_error("FASTA files cannot be sketched with the hash seed and scale of the sketch files given");
+
+    std::vector<hash_sketch> fasta_sketches = hash_sketches_from_fasta_files(fasta_filenames, parameters.window_length, parameters.mask, cache);
+    for (size_t j = 0; j < fasta_filenames.size(); ++j)
+    {
+        if (!save_directory.empty())
+        {
+            const std::string sketch_filename =
+                (std::filesystem::path(save_directory) / std::filesystem::path(fasta_filenames[j]).filename()).string() + SKETCH_FILE_EXTENSION;
+            if (!write_sketch_file(sketch_filename.c_str(), parameters, fasta_sketches[j]))
+                throw std::runtime_error("Unable to write sketch file " + sketch_filename);
+        }
+        sketches[fasta_indices[j]] = std::move(fasta_sketches[j]);
+    }
+    return sketches;
 }
 
 /**
  * @brief 
- * Given a number of FASTA files, this function computes an ANI estimate and writes it to a .csv file
- * 
+ * Query mode: finds the top k references closest to every query and writes them to a .csv file
+ * Queries and references are sketch files or FASTA files, so that a reference collection sketched once
+ * (e.g. with "--save-sketches") can be queried without its FASTA files
+ * The references are compared through an inverted index of their sketches (see sketch_query.hpp)
  * 
- * @tparam kmer_set_callable 
- * @tparam string_callable 
- * @param compute_kmer_set_pairs function to compute the kmer_set* pairs (must be compatible with compute_string_pairs)
- * @param compute_string_pairs function to compute the string pairs (must be compatible with compute_kmer_set_pairs)
- * @param window_size size of the kmer window
- * @param kmer_size number of characters to be used in the kmer
- * @param num_files number of FASTA files to be procesed
- * @param filenames array of char* representing the FASTA filenames
+ * @param window_size size of the kmer window, or 0 to take it from the sketch files or the default
+ * @param kmer_size number of characters to be used in the kmer, or 0 to take it from the sketch files or the default
+ * @param query_filenames list of the query files
+ * @param reference_filenames list of the reference files
+ * @param k number of references reported for every query
  * @param output_filename .csv file name
- * @param is_append bool to determine whether to
+ * @param cache sketch cache reused across runs, or nullptr to sketch every FASTA file
+ * @param save_directory directory the sketches of the FASTA files are written to, or "" to not write them
  */
-template <typename kmer_set_callable, typename string_callable>
-void test_compute_ANI_estimation_random_spaced_kmers(
-    kmer_set_callable compute_kmer_set_pairs,
-    string_callable compute_string_pairs,
+void test_compute_ANI_estimation_query(
     const int window_size,
     const int kmer_size,
-    const int num_files,
-    char *filenames[],
+    const std::vector<std::string> &query_filenames,
+    const std::vector<std::string> &reference_filenames,
+    const size_t k,
     const std::string &output_filename,
-    bool is_append
+    sketch_cache *cache = nullptr,
+    const std::string &save_directory = ""
 ){
-    // kmer_bitset mask = contiguous_kmer(kmer_size);
-    kmer_bitset mask = generate_random_spaced_seed_mask(window_size, kmer_size);
-    const int kmer_num_indices = (mask.count() / NUCLEOTIDE_BIT_SIZE); // How many nucleotides are in the kmer
+    std::vector<std::string> all_filenames = reference_filenames;
+    all_filenames.insert(all_filenames.end(), query_filenames.begin(), query_filenames.end());
+    const sketch_parameters parameters = query_sketch_parameters(all_filenames, window_size, kmer_size);
+    const int kmer_num_indices = (parameters.mask.count() / NUCLEOTIDE_BIT_SIZE); // How many nucleotides are in the kmer
 
     auto t_preprocess_string = std::chrono::high_resolution_clock::now();
-
-    std::vector<kmer_set> kmer_set_data = parallel_kmer_sets_from_fasta_files(
-        num_files,
-        filenames,
-        mask,
-        window_size,
-        sketching_condition);
+    std::vector<hash_sketch> reference_sketches = query_input_sketches(reference_filenames, parameters, cache, save_directory);
+    std::vector<hash_sketch> query_sketches = query_input_sketches(query_filenames, parameters, cache, save_directory);
     auto t_postprocess_kmers = std::chrono::high_resolution_clock::now();
     std::cout << "Time taken for sketching = " << std::chrono::duration<double, std::milli>(t_postprocess_kmers - t_preprocess_string).count() << " ms" << std::endl;
-    std::vector<kmer_set *> kmer_sets_init;
-    std::vector<std::string> kmer_filenames_init;
-
-    for (int i = 0; i < kmer_set_data.size(); ++i)
-    {
-        kmer_sets_init.push_back(&kmer_set_data[i]);
-        kmer_filenames_init.push_back(std::string(filenames[i]));
-    }
-
-    auto kmer_sets_pairwise = compute_kmer_set_pairs(kmer_sets_init);
-    auto kmer_filenames_pairwise = compute_string_pairs(kmer_filenames_init);
 
-    std::vector<int> intersection_vals = parallel_compute_pairwise_kmer_set_intersections(
-        kmer_sets_pairwise.first, 
-        kmer_sets_pairwise.second
-    );
+    std::vector<hash_sketch *> reference_pointers, query_pointers;
+    for (hash_sketch &hs : reference_sketches)
+        reference_pointers.push_back(&hs);
+    for (hash_sketch &hs : query_sketches)
+        query_pointers.push_back(&hs);
 
-    int data_size = intersection_vals.size();
+    const sketch_index index(reference_pointers);
+    auto t_prequery = std::chrono::high_resolution_clock::now();
+    std::vector<std::vector<query_hit>> hits = parallel_top_k_references(index, reference_pointers, query_pointers, k);
+    auto t_postquery = std::chrono::high_resolution_clock::now();
+    std::cout << "Time taken for query = " << std::chrono::duration<double, std::milli>(t_postquery - t_prequery).count() << " ms" << std::endl;
 
-    std::vector<double> containment_vals(data_size), ani_estimate_vals(data_size);
-    for (int i = 0; i < data_size; ++i)
+    std::ofstream output_file(output_filename);
+    if (!output_file.is_open())
     {
-        containment_vals[i] = containment(intersection_vals[i], kmer_sets_pairwise.first[i]->kmer_set_size());
-        ani_estimate_vals[i] = binomial_estimator(containment_vals[i], kmer_num_indices);
+        std::cerr << "Error: Unable to open file " << output_filename << " for writing." << std::endl;
+        return;
+    }
+    output_file << "Query,Reference,Rank,Containment,Estimated Value,Window Size,Mask" << std::endl;
+    for (size_t q = 0; q < hits.size(); ++q)
+    {
+        for (size_t rank = 0; rank < hits[q].size(); ++rank)
+        {
+            const query_hit &hit = hits[q][rank];
+            output_file << query_filenames[q] << "," << reference_filenames[hit.reference] << "," << rank + 1 << ","
+                        << hit.containment << "," << binomial_estimator(hit.containment, kmer_num_indices) << ","
+                        << parameters.window_length << "," << parameters.mask << '\n';
+        }
     }
-
-    auto t_postcomparison = std::chrono::high_resolution_clock::now();
-    std::cout << "Time taken for comparison = " << std::chrono::duration<double, std::milli>(t_postcomparison - t_postprocess_kmers).count() << " ms" << std::endl;
-    write_to_csv(
-        kmer_filenames_pairwise.first,
-        kmer_filenames_pairwise.second,
-        ani_estimate_vals,
-        window_size,
-        mask,
-        output_filename,
-        is_append);
 }
 
 int main(int argc, char *argv[])
@@ -216,25 +421,77 @@ int main(int argc, char *argv[])
     initialise_contiguous_kmer_array();
     initialise_reversing_kmer_array();
     const std::string filename = std::string(argv[1]);//"../../data_temp/Single-Family-Cross-Genus.csv";
-    test_compute_ANI_estimation_random_spaced_kmers(
-        compute_kmer_set_pointer_all_pairs,
-        compute_strings_all_pairs,
-        10, 
-        10, 
-        argc - 2, 
-        argv + 2,
-        filename,false
-    ); // test on all files given in argv
-    for (int k = 11; k <= 40; ++k){
-        test_compute_ANI_estimation_random_spaced_kmers(
-            compute_kmer_set_pointer_all_pairs,
-            compute_strings_all_pairs,
-            k, k, argc - 2, argv + 2,filename,true); // test on all files given in argv
-    }
-    for (int k = 10; k <= 40; ++k){
-        test_compute_ANI_estimation_random_spaced_kmers(
-            compute_kmer_set_pointer_all_pairs,
-            compute_strings_all_pairs,
-            k+10, k, argc - 2, argv + 2,filename,true); // test on all files given in argv
+
+    // Files are either given in argv, or listed in a manifest file with "--manifest <file>"
+    // Sketches are reused across runs with "--cache <directory>"
+    // Sketches are compared through an inverted index with "--inverted-index", skipping the pairs sharing no hash
+    // Pairs are screened on coarser nested sketches and only written if their ANI estimate is at least "--min-ani <ani>"
+    // With "--query <file>" (repeatable), the files given are references and only the top "--top-k <k>" of every query are written
+    // Queries and references may be FASTA files or sketch files, and the query mode uses "--window <size>" and "--kmer <size>",
+    // or the parameters of the sketch files; "--save-sketches <directory>" writes the sketches of the FASTA files there
+    std::vector<std::string> fasta_filenames;
+    std::vector<std::string> query_filenames;
+    std::unique_ptr<sketch_cache> cache;
+    bool use_inverted_index = false;
+    size_t top_k = DEFAULT_QUERY_TOP_K;
+    double min_ani = 0;
+    int query_window_size = 0, query_kmer_size = 0;
+    std::string save_directory;
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string argument(argv[i]);
+        if (argument == "--manifest" && i + 1 < argc)
+        {
+            const std::vector<std::string> manifest_filenames = read_manifest_file(argv[++i]);
+            fasta_filenames.insert(fasta_filenames.end(), manifest_filenames.begin(), manifest_filenames.end());
+        }
+        else if (argument == "--cache" && i + 1 < argc)
+            cache = std::make_unique<sketch_cache>(argv[++i]);
+        else if (argument == "--inverted-index")
+            use_inverted_index = true;
+        else if (argument == "--query" && i + 1 < argc)
+            query_filenames.push_back(argv[++i]);
+        else if (argument == "--top-k" && i + 1 < argc)
+            top_k = std::stoul(argv[++i]);
+        else if (argument == "--min-ani" && i + 1 < argc)
+            min_ani = std::stod(argv[++i]);
+        else if (argument == "--window" && i + 1 < argc)
+            query_window_size = std::stoi(argv[++i]);
+        else if (argument == "--kmer" && i + 1 < argc)
+            query_kmer_size = std::stoi(argv[++i]);
+        else if (argument == "--save-sketches" && i + 1 < argc)
+            save_directory = argv[++i];
+        else
+            fasta_filenames.push_back(argument);
     }
+
+    if (!query_filenames.empty())
+    {
+        test_compute_ANI_estimation_query(
+            query_window_size,
+            query_kmer_size,
+            query_filenames,
+            fasta_filenames,
+            top_k,
+            filename,
+            cache.get(),
+            save_directory);
+        return 0;
+    }
+
+    // Every configuration is sketched from a single read of the files
+    std::vector<std::pair<int, int>> window_and_kmer_sizes;
+    window_and_kmer_sizes.emplace_back(10, 10);
+    for (int k = 11; k <= 40; ++k)
+        window_and_kmer_sizes.emplace_back(k, k);
+    for (int k = 10; k <= 40; ++k)
+        window_and_kmer_sizes.emplace_back(k + 10, k);
+
+    test_compute_ANI_estimation_sweep(
+        window_and_kmer_sizes,
+        fasta_filenames,
+        filename,
+        cache.get(),
+        use_inverted_index,
+        min_ani); // test on all files given
 }
\ No newline at end of file
@@ -8,6 +8,8 @@
  * 
  * This is the main header file for functions and classes that interact with kmers
  */
+#ifndef KMER_HPP
+#define KMER_HPP
 // STL includes
 #include "stl_includes.hpp"
 
@@ -15,30 +17,34 @@
 #include <boost/dynamic_bitset.hpp>
 #include <boost/functional/hash.hpp>
 
-// OpenCilk needed for parallel processing of files
-#include <cilk/cilk.h>
+// Parallel loops, on OpenCilk or on the built-in thread pool
+#include "parallel.hpp"
 
 #include "logging.hpp"
+#include "fasta_processing.hpp"
+#include "kmer_word.hpp"
 
 /**
  * @brief 
- * We will be using the boost dynamic bitsets for representing the kmers
+ * We will be using the boost dynamic bitsets for representing masks
+ * The kmers themselves are held in fixed-width kmer words (see kmer_word.hpp)
  */
 typedef boost::dynamic_bitset<> kmer_bitset;
 
 /**
  * @brief 
- * Size of the kmer_bitset used throughout the code
- * Make this as small as is necessary, increasing it makes the program slower
+ * Size of the kmer_bitset used throughout the code, and the widest kmer window supported
  * Setting it to 6 gives 64-bit bitsets -> 32-mers, 7 -> 64-mers, 8 -> 128-mers, 9 -> 256-mers, 10 -> 512-mer
+ * The masks are written in full to the .csv files, so changing it changes the Mask column of the output
  * 
- * ONLY MODIFY THIS
+ * The sliding window picks the narrowest of uint64_t (32-mers), uint128_word (64-mers)
+ * and kmer_code (MAX_KMER_LENGTH-mers) that fits the window length
  */
 constexpr int LOG_KMER_BITSET_SIZE = 7;
 
 /**
  * @brief 
- * Disables parallel computation with OpenCilk
+ * Disables parallel computation (see parallel.hpp for the backends)
  */
 constexpr int PARALLEL_DISABLE = DEBUG | 0;
 
@@ -52,6 +58,13 @@ constexpr int PARALLEL_DISABLE = DEBUG | 0;
 constexpr int NUCLEOTIDE_BIT_SIZE = 2;
 constexpr int KMER_BITSET_SIZE = (1 << LOG_KMER_BITSET_SIZE);
 constexpr int MAX_KMER_LENGTH = (KMER_BITSET_SIZE / NUCLEOTIDE_BIT_SIZE);
+constexpr int KMER_CODE_WORDS = (KMER_BITSET_SIZE / 64);
+
+/**
+ * @brief 
+ * Fixed-width word wide enough for any kmer window, used to store kmers without heap allocations
+ */
+typedef multi_word<KMER_CODE_WORDS> kmer_code;
 
 // Functions for initialising contiguous kmers and the kmer reversing functions
 void initialise_contiguous_kmer_array();
@@ -70,14 +83,14 @@ kmer_bitset generate_random_spaced_seed_mask(
  * @param window_length Length of the whole kmer_window
  * @param kmer_bits Raw bits in the kmer
  * @param mask Mask used for the kmer
- * @param masked_bits Masked bits of the kmer, equal to kmer_bits & mask
+ * @param masked_bits Masked bits of the kmer compacted into the lowest 2k bits, equal to compact_kmer_code(kmer_bits, mask)
  */
 struct kmer
 {
     int window_length;       
-    kmer_bitset kmer_bits;   
-    kmer_bitset mask;        
-    kmer_bitset masked_bits; 
+    kmer_code kmer_bits;   
+    kmer_code mask;        
+    kmer_code masked_bits; 
 
     bool operator==(const kmer &other) const
     {
@@ -86,18 +99,19 @@ struct kmer
 };
 
 // Functions for computing canonical kmers
+kmer_code compact_kmer_code(const kmer_code &kmer_bits, const kmer_code &mask);
 kmer reverse_complement(kmer k);
 kmer canonical_kmer(kmer k);
 
 // Helper functions to compute a list of kmers from a list of nucleotide strings
 std::vector<kmer> nucleotide_string_list_to_kmers(
-    const std::vector<std::vector<uint8_t>> &nucleotide_strings,
+    const std::vector<acgt_string> &nucleotide_strings,
     const kmer_bitset &mask,
     const int window_length,
     const std::function<bool(const kmer)> &sketching_cond);
 void nucleotide_string_list_to_kmers_by_reference(
     std::vector<kmer> &kmer_list,
-    const std::vector<std::vector<uint8_t>> &nucleotide_strings,
+    const std::vector<acgt_string> &nucleotide_strings,
     const kmer_bitset &mask,
     const int window_length,
     const std::function<bool(const kmer)> &sketching_cond);
@@ -107,17 +121,17 @@ void nucleotide_string_list_to_kmers_by_reference(
  * Struct for computing kmer hashes using std::hash
  * This is primarily used in the hash map to check if an identical kmer exists
  * 
- * @param kmer_bitset_std_hash Hash for kmer_bitsets
+ * @param kmer_code_boost_hash Hash for kmer_codes
  * @param int_std_hash Hash for int
  */
 struct kmer_hash
 {
-    std::hash<kmer_bitset> kmer_bitset_std_hash;
+    boost::hash<kmer_code> kmer_code_boost_hash;
     std::hash<int> int_std_hash;
     inline size_t operator()(const kmer &k) const
     {
-        size_t k_hash = (kmer_bitset_std_hash(k.masked_bits) ^
-                         kmer_bitset_std_hash(k.mask) ^
+        size_t k_hash = (kmer_code_boost_hash(k.masked_bits) ^
+                         kmer_code_boost_hash(k.mask) ^
                          int_std_hash(k.window_length));
         return k_hash;
     }
@@ -127,27 +141,43 @@ struct kmer_hash
  * @brief 
  * Struct for FracMinHash, initialised with a nonce to create a different hash
  * This is primarily used in FracMinHash to determine which kmers are kept in the sketching process
+ * The hash only depends on the compacted kmer code, so the sliding window can compute it
+ * without building a kmer (see kmer_word_hash)
  * 
- * @param kmer_bitset_boost_hash Hash for kmer_bitsets
- * @param int_boost_hash Hash for int
- * @param nonce Parameter given to generate a different hash function
+ * @param hash_seed Seed derived from the nonce to generate a different hash function
  */
 struct frac_min_hash
 {
-    boost::hash<kmer_bitset> kmer_bitset_boost_hash;
-    boost::hash<int> int_boost_hash;
-    int nonce;
+    uint64_t hash_seed;
 
-    frac_min_hash(int n) : nonce(int_boost_hash(n)) {}
+    frac_min_hash(int n) : hash_seed(mix_hash64((uint64_t)n)) {}
 
     // Hash function
-    inline size_t operator()(const kmer &k) const
+    inline uint64_t operator()(const kmer &k) const
     {
-        size_t k_hash = (kmer_bitset_boost_hash(k.masked_bits) ^ kmer_bitset_boost_hash(k.mask) ^ int_boost_hash(k.window_length) ^ nonce);
-        return k_hash;
+        return hash_code(k.masked_bits);
+    }
+
+    // Hash function on a compacted kmer code held in any kmer word type
+    template <typename code_t>
+    inline uint64_t hash_code(const code_t &code) const
+    {
+        return kmer_word_hash(code, hash_seed);
     }
 };
 
+/**
+ * @brief 
+ * Hash threshold keeping a 1/scale fraction of all kmers in FracMinHash (kmers with hash < threshold are kept)
+ * 
+ * @param scale scale factor of the sketch
+ * @return hash threshold
+ */
+inline uint64_t frac_min_hash_threshold(const uint64_t scale)
+{
+    return UINT64_MAX / scale;
+}
+
 // hash table for kmers
 typedef std::unordered_map<kmer, int, kmer_hash> kmer_hash_table;
 
@@ -155,7 +185,7 @@ typedef std::unordered_map<kmer, int, kmer_hash> kmer_hash_table;
  * @brief 
  * Custom struct to store the kmers in a set
  * 
- * @param kmer_hashes hash table to store the kmers
+ * @param kmer_hashes hash table to store the kmers, mapping each kmer to the number of times it was inserted
  */
 struct kmer_set
 {
@@ -171,12 +201,23 @@ struct kmer_set
     {
         for (const kmer &k : kmers)
         {
-            if (DEBUG)
-                std::cout << "Inserting kmer " << k.masked_bits << std::endl;
-            kmer_hashes[k] = 1;
+            insert_kmer(k);
         }
     }
 
+    /**
+     * @brief 
+     * Helper function for inserting a single kmer, counting it once more if it is already in the set
+     * 
+     * @param k kmer to be inserted
+     */
+    inline void insert_kmer(const kmer &k)
+    {
+        if (DEBUG)
+            std::cout << "Inserting kmer " << k.masked_bits << std::endl;
+        ++kmer_hashes[k];
+    }
+
     /**
      * @brief 
      * Helper function for computing the size of the kmer set
@@ -190,6 +231,8 @@ struct kmer_set
 };
 // Helper function for computing kmer set intersection
 int kmer_set_intersection(const kmer_set &ks1, const kmer_set &ks2);
+// Helper function for computing the union of kmer sets
+kmer_set merge_sketches(std::vector<kmer_set> &kmer_sets);
 
 // Helper functions to compute kmer sets from fasta files
 kmer_set kmer_set_from_fasta_file(
@@ -215,4 +258,5 @@ std::vector<int> compute_pairwise_kmer_set_intersections(
     const std::vector<kmer_set *> &kmer_sets_2);
 std::vector<int> parallel_compute_pairwise_kmer_set_intersections(
     const std::vector<kmer_set *> &kmer_sets_1,
-    const std::vector<kmer_set *> &kmer_sets_2);
\ No newline at end of file
+    const std::vector<kmer_set *> &kmer_sets_2);
+#endif
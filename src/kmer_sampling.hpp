@@ -0,0 +1,393 @@
+/**
+ * @file kmer_sampling.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the position-based sampling schemes, which pick kmers by comparing them with their
+ * neighbours instead of testing each kmer on its own hash:
+ *  closed syncmers : windows whose smallest s-mer is at the start or at the end of the window
+ *  open syncmers   : windows whose smallest s-mer is at a fixed offset in the window
+ *  minimizers      : the kmer with the smallest hash among every w consecutive kmers
+ * Both schemes work on spaced seeds: the window (of window_length nucleotides) is what is compared with its neighbours,
+ * and the spaced kmer of the selected windows is the one sampled
+ * Syncmers guarantee that a sampled window is decided by its own nucleotides, and minimizers that every w consecutive
+ * windows contain a sampled kmer, so both give sparser but better spread and better conserved samples than a hash threshold
+ *
+ * The smallest s-mer (or kmer) of the sliding window is kept in a monotone deque, at amortised O(1) cost per nucleotide
+ * The sampled kmers then go through a sketching policy and a sink like the kmers of kmer_sliding.hpp,
+ * so e.g. FracMinHash can still be applied on top of the sampling
+ */
+#ifndef KMER_SAMPLING_HPP
+#define KMER_SAMPLING_HPP
+#include "kmer_sliding.hpp"
+#include "fasta_processing.hpp"
+
+constexpr int SAMPLING_DEBUG = DEBUG | 0;
+
+/**
+ * @brief
+ * Position-based sampling schemes
+ */
+enum class sampling_scheme
+{
+    closed_syncmer,
+    open_syncmer,
+    minimizer
+};
+
+/**
+ * @brief
+ * Parameters of a sampling scheme
+ *
+ * @param scheme sampling scheme used
+ * @param smer_length length s of the s-mers compared within a window, for syncmers (s <= 32)
+ * @param syncmer_offset position of the smallest s-mer in the windows of open syncmers
+ * @param minimizer_window number w of consecutive kmers among which a minimizer is picked
+ * @param hash_seed seed of the hashes ordering the s-mers and kmers
+ */
+struct sampling_parameters
+{
+    sampling_scheme scheme = sampling_scheme::closed_syncmer;
+    int smer_length = 0;
+    int syncmer_offset = 0;
+    int minimizer_window = 0;
+    uint64_t hash_seed = 0;
+};
+
+/**
+ * @brief
+ * Minimum of a sliding window of entries, kept in a monotone deque held in a ring buffer
+ * The deque holds the entries that are smaller than every entry pushed after them, in increasing order of hash,
+ * so the front is the minimum, ties going to the oldest entry
+ * Every entry is pushed and popped at most once, which costs amortised O(1) per entry
+ *
+ * @tparam entry_t entry type, with a size_t position and a uint64_t hash
+ */
+template <typename entry_t>
+struct sliding_window_minimum
+{
+    std::vector<entry_t> entries;
+    size_t head = 0;
+    size_t size = 0;
+
+    explicit sliding_window_minimum(const size_t window_size)
+        : entries(std::bit_ceil(window_size + 1)) {}
+
+    inline void clear()
+    {
+        head = 0;
+        size = 0;
+    }
+
+    inline const entry_t &front() const
+    {
+        return entries[head];
+    }
+
+    /**
+     * @brief
+     * Adds an entry, removing the larger entries before it, which can no longer be the minimum
+     */
+    inline void push(const entry_t &entry)
+    {
+        const size_t index_mask = entries.size() - 1;
+        while (size > 0 && entries[(head + size - 1) & index_mask].hash > entry.hash)
+            --size;
+        entries[(head + size) & index_mask] = entry;
+        ++size;
+    }
+
+    /**
+     * @brief
+     * Removes the entries whose position is before first_position, which have left the window
+     */
+    inline void expire(const size_t first_position)
+    {
+        const size_t index_mask = entries.size() - 1;
+        while (size > 0 && entries[head].position < first_position)
+        {
+            head = (head + 1) & index_mask;
+            --size;
+        }
+    }
+};
+
+/**
+ * @brief
+ * Canonical s-mer of length smer_length starting at offset in a window, i.e. the smaller of the s-mer on the main strand
+ * and its reverse complement, read from the window words
+ *
+ * @param window current window
+ * @param window_length window size of the kmer
+ * @param smer_length length of the s-mer, at most 32
+ * @param offset offset of the first nucleotide of the s-mer in the window
+ * @return canonical s-mer, 2 bits per nucleotide
+ */
+template <typename word_t>
+inline uint64_t canonical_smer(const kmer_window<word_t> &window, const int window_length, const int smer_length, const int offset)
+{
+    const uint64_t smer_bits = low_bits_kmer_word<uint64_t>(NUCLEOTIDE_BIT_SIZE * smer_length);
+
+    // The oldest nucleotide of the window is in the highest bits of the main strand and in the lowest bits of the complement strand
+    const uint64_t main_smer = kmer_word_lane(window.main_strand >> (NUCLEOTIDE_BIT_SIZE * (window_length - offset - smer_length)), 0) & smer_bits;
+    const uint64_t complement_smer = kmer_word_lane(window.complement_strand >> (NUCLEOTIDE_BIT_SIZE * offset), 0) & smer_bits;
+    return std::min(main_smer, complement_smer);
+}
+
+/**
+ * @brief
+ * Samples the windows of an ACGT string with a syncmer scheme, and passes the spaced kmers of the sampled windows
+ * through the policy to the sink
+ *
+ * @tparam word_t fixed-width word type holding the window
+ * @tparam code_t fixed-width word type holding the compacted kmer
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @tparam sink_t kmer sink (see kmer_sink.hpp)
+ * @param sink sink receiving the sampled kmers
+ * @param nucleotide_string ACGT string representing the ACGT nucleotides
+ * @param seed spaced seed used, prepared for word_t
+ * @param sampling parameters of the syncmer scheme
+ * @param policy sketching policy deciding which of the sampled kmers are used
+ */
+template <typename word_t, typename code_t, sketching_policy policy_t, kmer_sink sink_t>
+inline void nucleotide_string_to_syncmers(
+    sink_t &sink,
+    const acgt_string &nucleotide_string,
+    const spaced_seed<word_t> &seed,
+    const sampling_parameters &sampling,
+    policy_t &policy)
+{
+    struct smer_entry
+    {
+        size_t position;
+        uint64_t hash;
+    };
+
+    const int window_length = seed.window_length;
+    const int smer_length = sampling.smer_length;
+    const int last_offset = window_length - smer_length;
+    sliding_window_minimum<smer_entry> smallest_smer(last_offset + 1);
+    size_t window_idx = 0;
+
+    for_each_canonical_kmer<code_t>(
+        nucleotide_string,
+        seed,
+        0,
+        nucleotide_string.size(),
+        [&](const kmer_window<word_t> &window, const code_t &canonical_code, const bool main_strand_is_canonical)
+        {
+            // The first window brings all its s-mers, every later window only its last one
+            for (int offset = (window_idx == 0 ? 0 : last_offset); offset <= last_offset; ++offset)
+            {
+                const uint64_t smer = canonical_smer(window, window_length, smer_length, offset);
+                smallest_smer.push({window_idx + offset, kmer_word_hash(smer, sampling.hash_seed)});
+            }
+            smallest_smer.expire(window_idx);
+
+            const size_t smallest_offset = smallest_smer.front().position - window_idx;
+            ++window_idx;
+            const bool is_syncmer = (sampling.scheme == sampling_scheme::open_syncmer)
+                                        ? (smallest_offset == (size_t)sampling.syncmer_offset)
+                                        : (smallest_offset == 0 || smallest_offset == (size_t)last_offset);
+            if (!is_syncmer || !policy.accept_code(canonical_code))
+                return;
+
+            const kmer canon_kmer = make_canonical_kmer(seed, window, canonical_code, main_strand_is_canonical);
+            if (policy.accept_kmer(canon_kmer))
+                sink.add(canon_kmer);
+        });
+}
+
+/**
+ * @brief
+ * Samples the kmers of an ACGT string with (w, k)-minimizers: the kmer with the smallest hash among every
+ * minimizer_window consecutive kmers (the oldest one on ties), each sampled kmer being passed once through the policy to the sink
+ * Strings with fewer than minimizer_window kmers have no minimizer
+ *
+ * @tparam word_t fixed-width word type holding the window
+ * @tparam code_t fixed-width word type holding the compacted kmer
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @tparam sink_t kmer sink (see kmer_sink.hpp)
+ * @param sink sink receiving the sampled kmers
+ * @param nucleotide_string ACGT string representing the ACGT nucleotides
+ * @param seed spaced seed used, prepared for word_t
+ * @param sampling parameters of the minimizer scheme
+ * @param policy sketching policy deciding which of the sampled kmers are used
+ */
+template <typename word_t, typename code_t, sketching_policy policy_t, kmer_sink sink_t>
+inline void nucleotide_string_to_minimizers(
+    sink_t &sink,
+    const acgt_string &nucleotide_string,
+    const spaced_seed<word_t> &seed,
+    const sampling_parameters &sampling,
+    policy_t &policy)
+{
+    // The kmer is only built for the sampled entries, from its canonical code and canonical strand
+    struct kmer_entry
+    {
+        size_t position;
+        uint64_t hash;
+        code_t canonical_code;
+        word_t canonical_kmer_bits;
+    };
+
+    const size_t minimizer_window = sampling.minimizer_window;
+    sliding_window_minimum<kmer_entry> smallest_kmer(minimizer_window);
+    size_t kmer_idx = 0;
+    size_t last_sampled_idx = SIZE_MAX;
+
+    for_each_canonical_kmer<code_t>(
+        nucleotide_string,
+        seed,
+        0,
+        nucleotide_string.size(),
+        [&](const kmer_window<word_t> &window, const code_t &canonical_code, const bool main_strand_is_canonical)
+        {
+            smallest_kmer.push({
+                kmer_idx,
+                kmer_word_hash(canonical_code, sampling.hash_seed),
+                canonical_code,
+                main_strand_is_canonical ? (window.main_strand & window.window_bits) : window.complement_strand});
+            ++kmer_idx;
+            if (kmer_idx < minimizer_window)
+                return;
+            smallest_kmer.expire(kmer_idx - minimizer_window);
+
+            const kmer_entry &minimizer = smallest_kmer.front();
+            if (minimizer.position == last_sampled_idx)
+                return;
+            last_sampled_idx = minimizer.position;
+            if (SAMPLING_DEBUG)
+                std::cout << "Minimizer at kmer " << minimizer.position << " with hash " << minimizer.hash << std::endl;
+
+            if (!policy.accept_code(minimizer.canonical_code))
+                return;
+            const kmer canon_kmer(
+                seed.window_length,
+                convert_kmer_word<kmer_code>(minimizer.canonical_kmer_bits),
+                seed.mask_code,
+                convert_kmer_word<kmer_code>(minimizer.canonical_code));
+            if (policy.accept_kmer(canon_kmer))
+                sink.add(canon_kmer);
+        });
+}
+
+/**
+ * @brief
+ * Sampled version of nucleotide_string_list_to_sink: passes the kmers picked by a sampling scheme in a list of
+ * nucleotide strings through the policy to a sink
+ * The sink is not finished, so that several lists can be added to the same sink
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @tparam sink_t kmer sink (see kmer_sink.hpp)
+ * @param sink sink receiving the sampled kmers
+ * @param nucleotide_strings list of ACGT strings representing the ACGT nucleotides
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param sampling parameters of the sampling scheme
+ * @param policy sketching policy deciding which of the sampled kmers are used
+ */
+template <sketching_policy policy_t, kmer_sink sink_t>
+void nucleotide_string_list_to_sampled_sink(
+    sink_t &sink,
+    const std::vector<acgt_string> &nucleotide_strings,
+    const kmer_bitset &mask,
+    const int window_length,
+    const sampling_parameters &sampling,
+    policy_t &policy)
+{
+    if (sampling.scheme == sampling_scheme::minimizer && sampling.minimizer_window <= 0)
+        throw std::runtime_error("Minimizer window must be positive");
+    if (sampling.scheme != sampling_scheme::minimizer)
+    {
+        if (sampling.smer_length <= 0 || sampling.smer_length > 32 || sampling.smer_length > window_length)
+            throw std::runtime_error("Syncmer s-mer length must be between 1 and min(32, window length)");
+        if (sampling.syncmer_offset < 0 || sampling.syncmer_offset > window_length - sampling.smer_length)
+            throw std::runtime_error("Open syncmer offset must be within the window");
+    }
+
+    // Pick the word types once for the whole list
+    dispatch_spaced_seed(
+        mask,
+        window_length,
+        [&](const auto &seed, auto code_tag)
+        {
+            typedef typename std::remove_cvref_t<decltype(seed)>::word_type word_t;
+            typedef decltype(code_tag) code_t;
+            for (acgt_string const &s : nucleotide_strings)
+            {
+                if (sampling.scheme == sampling_scheme::minimizer)
+                    nucleotide_string_to_minimizers<word_t, code_t>(sink, s, seed, sampling, policy);
+                else
+                    nucleotide_string_to_syncmers<word_t, code_t>(sink, s, seed, sampling, policy);
+            }
+        });
+}
+
+/**
+ * @brief
+ * Sampled version of hash_sketch_from_nucleotide_strings: generates a hash_sketch from the kmers picked by a sampling
+ * scheme in a list of ACGT strings
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param nucleotide_strings list of ACGT strings representing the ACGT nucleotides
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param sampling parameters of the sampling scheme
+ * @param policy sketching policy deciding which of the sampled kmers are used, copied so that stateful policies start afresh for every file
+ * @param fmh hash function whose hashes are stored in the sketch
+ * @return hash_sketch containing the hashes of the sampled kmers
+ */
+template <sketching_policy policy_t>
+hash_sketch sampled_hash_sketch_from_nucleotide_strings(
+    const std::vector<acgt_string> &nucleotide_strings,
+    const kmer_bitset &mask,
+    const int window_length,
+    const sampling_parameters &sampling,
+    policy_t policy,
+    const frac_min_hash &fmh)
+{
+    hash_sketch hs;
+    sorted_hash_sink sink(fmh, hs.hashes);
+    nucleotide_string_list_to_sampled_sink(sink, nucleotide_strings, mask, window_length, sampling, policy);
+    sink.finish();
+    policy.finalise(hs);
+    return hs;
+}
+
+/**
+ * @brief
+ * Sampled version of hash_sketch_from_fasta_file: generates a hash_sketch from the kmers picked by a sampling
+ * scheme in a .fasta file
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param fasta_filename path to the .fasta file to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param sampling parameters of the sampling scheme
+ * @param policy sketching policy deciding which of the sampled kmers are used
+ * @param fmh hash function whose hashes are stored in the sketch
+ * @return hash_sketch containing the hashes of the sampled kmers of that file
+ */
+template <sketching_policy policy_t>
+hash_sketch sampled_hash_sketch_from_fasta_file(
+    const char fasta_filename[],
+    const kmer_bitset &mask,
+    const int window_length,
+    const sampling_parameters &sampling,
+    policy_t policy,
+    const frac_min_hash &fmh)
+{
+    return sampled_hash_sketch_from_nucleotide_strings(
+        nucleotide_strings_from_fasta_file(fasta_filename),
+        mask,
+        window_length,
+        sampling,
+        policy,
+        fmh);
+}
+
+#endif
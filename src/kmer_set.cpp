@@ -8,6 +8,7 @@
  * 
  */
 #include "kmer.hpp"
+#include "kmer_set.hpp"
 #include "fasta_processing.hpp"
 
 constexpr int KMER_SET_DEBUG = DEBUG | 0;
@@ -40,10 +41,44 @@ int kmer_set_intersection(const kmer_set &ks1, const kmer_set &ks2)
     return inters;
 }
 
+/**
+ * @brief
+ * Helper function to compute the union of a list of kmer sets, adding up the counts of the kmers found in several sets
+ * The kmers of the other sets are moved into the largest set, so the list is left in a valid but unspecified state
+ *
+ * @param kmer_sets list of kmer sets
+ * @return kmer_set containing every kmer in the list
+ */
+kmer_set merge_sketches(std::vector<kmer_set> &kmer_sets)
+{
+    if (kmer_sets.empty())
+        return kmer_set();
+
+    auto largest = std::max_element(
+        kmer_sets.begin(),
+        kmer_sets.end(),
+        [](const kmer_set &a, const kmer_set &b)
+        { return a.kmer_set_size() < b.kmer_set_size(); });
+    kmer_set merged = std::move(*largest);
+
+    // The largest set has been moved from, so it is skipped explicitly rather than relying on it being left empty
+    for (auto it = kmer_sets.begin(); it != kmer_sets.end(); ++it)
+    {
+        if (it == largest)
+            continue;
+        merged.kmer_hashes.merge(it->kmer_hashes);
+
+        // merge leaves the kmers already in the merged set behind, only their counts remain to be added
+        for (const auto &[k, count] : it->kmer_hashes)
+            merged.kmer_hashes[k] += count;
+    }
+    return merged;
+}
+
 /**
  * @brief
  * Helper function that generates a kmer_set from a .fasta file
- * Composes a number of other helper functions together
+ * Thin wrapper over the templated version in kmer_set.hpp, which should be preferred since it can inline the condition
  *
  * @param fasta_filename path to the .fasta file to be read
  * @param mask spaced seed mask used
@@ -57,19 +92,17 @@ kmer_set kmer_set_from_fasta_file(
     const int window_length,
     const std::function<bool(const kmer)> &sketching_cond)
 {
-    kmer_set ks;
-    ks.insert_kmers(
-        nucleotide_string_list_to_kmers(
-            nucleotide_strings_from_fasta_file(fasta_filename),
-            mask,
-            window_length,
-            sketching_cond));
-    return ks;
+    return kmer_set_from_fasta_file(
+        fasta_filename,
+        mask,
+        window_length,
+        predicate_policy<const std::function<bool(const kmer)> &>(sketching_cond));
 }
 
 /**
  * @brief
  * Iterates over a list of filenames and creates a kmer_set for each file
+ * Thin wrapper over the templated version in kmer_set.hpp
  *
  * @param num_files number of files to be processed
  * @param fasta_filenames pointer to the list of file names to be read
@@ -85,22 +118,18 @@ std::vector<kmer_set> kmer_sets_from_fasta_files(
     const int window_length,
     const std::function<bool(const kmer)> &sketching_cond)
 {
-    std::vector<kmer_set> kmer_sets(num_files);
-    for (int i = 0; i < num_files; ++i)
-    {
-        kmer_sets[i] = kmer_set_from_fasta_file(
-            fasta_filenames[i],
-            mask,
-            window_length,
-            sketching_cond);
-    }
-    return kmer_sets;
+    return kmer_sets_from_fasta_files(
+        num_files,
+        fasta_filenames,
+        mask,
+        window_length,
+        predicate_policy<const std::function<bool(const kmer)> &>(sketching_cond));
 }
 
 /**
  * @brief
  * Parallel version of kmer_sets_from_fasta_files
- * Uses a cilk_for to parallelize the for loop over the fasta files
+ * Thin wrapper over the templated version in kmer_set.hpp
  *
  * @param num_files number of files to be processed
  * @param fasta_filenames pointer to the list of filenames to be read
@@ -116,20 +145,12 @@ std::vector<kmer_set> parallel_kmer_sets_from_fasta_files(
     const int window_length,
     const std::function<bool(const kmer)> &sketching_cond)
 {
-    // Debug: If the PARALLEL_DISABLE flag is set to 0, use the serial version
-    if (PARALLEL_DISABLE)
-        return kmer_sets_from_fasta_files(num_files, fasta_filenames, mask, window_length, sketching_cond);
-
-    std::vector<kmer_set> kmer_sets(num_files);
-    cilk_for(int i = 0; i < num_files; ++i)
-    {
-        kmer_sets[i] = kmer_set_from_fasta_file(
-            fasta_filenames[i],
-            mask,
-            window_length,
-            sketching_cond);
-    }
-    return kmer_sets;
+    return parallel_kmer_sets_from_fasta_files(
+        num_files,
+        fasta_filenames,
+        mask,
+        window_length,
+        predicate_policy<const std::function<bool(const kmer)> &>(sketching_cond));
 }
 
 /**
@@ -158,7 +179,7 @@ std::vector<int> compute_pairwise_kmer_set_intersections(
 
 /**
  * @brief
- * Parallel version of compute_pairwise_kmer_set_intersections using cilk_for
+ * Parallel version of compute_pairwise_kmer_set_intersections using parallel_for
  *
  * @param kmer_sets_1 first list of kmer_set pointers
  * @param kmer_sets_2 second list of kmer_set pointers
@@ -176,9 +197,12 @@ std::vector<int> parallel_compute_pairwise_kmer_set_intersections(
         throw std::runtime_error("Lists of kmer sets for intersection computation have different lengths");
     }
     std::vector<int> intersection_values(kmer_sets_1.size());
-    cilk_for(int i = 0; i < kmer_sets_1.size(); ++i)
-    {
-        intersection_values[i] = kmer_set_intersection(*kmer_sets_1[i], *kmer_sets_2[i]);
-    }
+    parallel_for(
+        (size_t)0,
+        kmer_sets_1.size(),
+        [&](const size_t i)
+        {
+            intersection_values[i] = kmer_set_intersection(*kmer_sets_1[i], *kmer_sets_2[i]);
+        });
     return intersection_values;
 }
\ No newline at end of file
@@ -0,0 +1,687 @@
+/**
+ * @file kmer_set.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the versions of the kmer_set builders templated on a sketching policy,
+ * the hash_sketch, abundance_sketch and flat_kmer_set builders, and sketch_fasta_file, which sketches a file into any kmer sink
+ * The std::function versions declared in kmer.hpp are thin wrappers over these
+ */
+#ifndef KMER_SET_HPP
+#define KMER_SET_HPP
+#include "kmer.hpp"
+#include "kmer_sliding.hpp"
+#include "sketching_policy.hpp"
+#include "kmer_sink.hpp"
+#include "hash_sketch.hpp"
+#include "abundance_sketch.hpp"
+#include "flat_kmer_set.hpp"
+#include "fasta_processing.hpp"
+
+/**
+ * @brief
+ * Reads a .fasta file and passes the accepted kmers straight to a sink
+ * The sink is not finished, so that several files can be added to the same sink
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @tparam sink_t kmer sink (see kmer_sink.hpp)
+ * @param sink sink receiving the accepted kmers
+ * @param fasta_filename path to the .fasta file to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ */
+template <sketching_policy policy_t, kmer_sink sink_t>
+void sketch_fasta_file(
+    sink_t &sink,
+    const char fasta_filename[],
+    const kmer_bitset &mask,
+    const int window_length,
+    policy_t &policy)
+{
+    nucleotide_string_list_to_sink(
+        sink,
+        nucleotide_strings_from_fasta_file(fasta_filename),
+        mask,
+        window_length,
+        policy);
+}
+
+/**
+ * @brief
+ * Default number of kmer windows sketched by one worker when a file is sketched in parallel
+ */
+constexpr size_t DEFAULT_SKETCH_CHUNK_LENGTH = (1 << 18);
+
+/**
+ * @brief
+ * Sketches a list of ACGT strings in parallel by splitting them into chunks (see split_nucleotide_strings),
+ * sketching each chunk into its own sketch with its own copy of the policy, and merging the sketches at the end
+ * The result is identical to sketching the strings serially, including for stateful policies such as bottom-k,
+ * since the copies of the policy are merged before the final sketch is finalised
+ *
+ * @tparam sketch_t sketch type, with a merge_sketches overload
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param nucleotide_strings list of ACGT strings representing the ACGT nucleotides
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ * @param empty_sketch empty sketch that every chunk sketch starts from
+ * @param make_sink callable taking a sketch_t & and returning a kmer sink adding to it
+ * @param chunk_length number of kmer windows in each chunk
+ * @return sketch of all the strings
+ */
+template <typename sketch_t, sketching_policy policy_t, typename sink_factory>
+sketch_t chunked_sketch_nucleotide_strings(
+    const std::vector<acgt_string> &nucleotide_strings,
+    const kmer_bitset &mask,
+    const int window_length,
+    const policy_t &policy,
+    const sketch_t &empty_sketch,
+    sink_factory &&make_sink,
+    const size_t chunk_length)
+{
+    const std::vector<nucleotide_string_chunk> chunks = split_nucleotide_strings(nucleotide_strings, window_length, chunk_length);
+    if (chunks.empty())
+        return empty_sketch;
+
+    std::vector<sketch_t> chunk_sketches(chunks.size(), empty_sketch);
+    std::vector<policy_t> chunk_policies(chunks.size(), policy);
+
+    // Pick the word types once for the whole list
+    dispatch_spaced_seed(
+        mask,
+        window_length,
+        [&](const auto &seed, auto code_tag)
+        {
+            typedef typename std::remove_cvref_t<decltype(seed)>::word_type word_t;
+            typedef decltype(code_tag) code_t;
+
+            auto sketch_chunk = [&](const size_t i)
+            {
+                const nucleotide_string_chunk &chunk = chunks[i];
+                auto sink = make_sink(chunk_sketches[i]);
+                nucleotide_string_to_kmers<word_t, code_t>(
+                    sink,
+                    nucleotide_strings[chunk.string_idx],
+                    seed,
+                    chunk_policies[i],
+                    chunk.start_idx,
+                    chunk.end_idx);
+                sink.finish();
+
+                // Finalising early keeps the chunk sketches of stateful policies small
+                chunk_policies[i].finalise(chunk_sketches[i]);
+            };
+
+            // Debug: If the PARALLEL_DISABLE flag is set to 0, use the serial version
+            if (PARALLEL_DISABLE)
+            {
+                for (size_t i = 0; i < chunks.size(); ++i)
+                    sketch_chunk(i);
+            }
+            else
+            {
+                parallel_for((size_t)0, chunks.size(), sketch_chunk);
+            }
+        });
+
+    policy_t merged_policy = policy;
+    for (const policy_t &chunk_policy : chunk_policies)
+        merged_policy.merge(chunk_policy);
+
+    sketch_t merged_sketch = merge_sketches(chunk_sketches);
+    merged_policy.finalise(merged_sketch);
+    return merged_sketch;
+}
+
+/**
+ * @brief
+ * Parallel version of kmer_set_from_fasta_file, which splits the file between workers
+ * Useful for a few large files, where parallelising over the files leaves most workers idle
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param fasta_filename path to the .fasta file to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ * @param chunk_length number of kmer windows sketched by one worker
+ * @return kmer_set containing the kmers sketched from that file
+ */
+template <sketching_policy policy_t>
+kmer_set parallel_kmer_set_from_fasta_file(
+    const char fasta_filename[],
+    const kmer_bitset &mask,
+    const int window_length,
+    const policy_t &policy,
+    const size_t chunk_length = DEFAULT_SKETCH_CHUNK_LENGTH)
+{
+    return chunked_sketch_nucleotide_strings(
+        nucleotide_strings_from_fasta_file(fasta_filename),
+        mask,
+        window_length,
+        policy,
+        kmer_set(),
+        [](kmer_set &ks)
+        { return kmer_set_sink(ks); },
+        chunk_length);
+}
+
+/**
+ * @brief
+ * Helper function that generates a kmer_set from a list of ACGT strings already read from a file
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param nucleotide_strings list of ACGT strings representing the ACGT nucleotides
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used, copied so that stateful policies start afresh for every file
+ * @return kmer_set containing the kmers sketched from the strings
+ */
+template <sketching_policy policy_t>
+kmer_set kmer_set_from_nucleotide_strings(
+    const std::vector<acgt_string> &nucleotide_strings,
+    const kmer_bitset &mask,
+    const int window_length,
+    policy_t policy)
+{
+    kmer_set ks;
+    kmer_set_sink sink(ks);
+    nucleotide_string_list_to_sink(sink, nucleotide_strings, mask, window_length, policy);
+    sink.finish();
+    policy.finalise(ks);
+    return ks;
+}
+
+/**
+ * @brief
+ * Helper function that generates a kmer_set from a .fasta file
+ * The kmers are inserted into the kmer_set as they are found, without an intermediate list of kmers
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param fasta_filename path to the .fasta file to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used, copied so that stateful policies start afresh for every file
+ * @return kmer_set containing the kmers sketched from that file
+ */
+template <sketching_policy policy_t>
+kmer_set kmer_set_from_fasta_file(
+    const char fasta_filename[],
+    const kmer_bitset &mask,
+    const int window_length,
+    policy_t policy)
+{
+    return kmer_set_from_nucleotide_strings(
+        nucleotide_strings_from_fasta_file(fasta_filename),
+        mask,
+        window_length,
+        policy);
+}
+
+/**
+ * @brief
+ * Iterates over a list of filenames and creates a kmer_set for each file
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param num_files number of files to be processed
+ * @param fasta_filenames pointer to the list of file names to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ * @return a list of kmer_sets corresponding to the file names given
+ */
+template <sketching_policy policy_t>
+std::vector<kmer_set> kmer_sets_from_fasta_files(
+    const int num_files,
+    char *fasta_filenames[],
+    const kmer_bitset &mask,
+    const int window_length,
+    const policy_t &policy)
+{
+    std::vector<kmer_set> kmer_sets(num_files);
+    for (int i = 0; i < num_files; ++i)
+    {
+        kmer_sets[i] = kmer_set_from_fasta_file(
+            fasta_filenames[i],
+            mask,
+            window_length,
+            policy);
+    }
+    return kmer_sets;
+}
+
+/**
+ * @brief
+ * Parallel version of kmer_sets_from_fasta_files
+ * Uses a parallel_for over the fasta files, whose chunks run on the same workers
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param num_files number of files to be processed
+ * @param fasta_filenames pointer to the list of filenames to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ * @return a list of kmer_sets corresponding to the file names given
+ */
+template <sketching_policy policy_t>
+std::vector<kmer_set> parallel_kmer_sets_from_fasta_files(
+    const int num_files,
+    char *fasta_filenames[],
+    const kmer_bitset &mask,
+    const int window_length,
+    const policy_t &policy)
+{
+    // Debug: If the PARALLEL_DISABLE flag is set to 0, use the serial version
+    if (PARALLEL_DISABLE)
+        return kmer_sets_from_fasta_files(num_files, fasta_filenames, mask, window_length, policy);
+
+    // Large files are also split between workers, so a few large files do not leave the other workers idle
+    std::vector<kmer_set> kmer_sets(num_files);
+    parallel_for(
+        0,
+        num_files,
+        [&](const int i)
+        {
+            kmer_sets[i] = parallel_kmer_set_from_fasta_file(
+                fasta_filenames[i],
+                mask,
+                window_length,
+                policy);
+        });
+    return kmer_sets;
+}
+
+/**
+ * @brief
+ * Helper function that generates a hash_sketch from a list of ACGT strings already read from a file
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param nucleotide_strings list of ACGT strings representing the ACGT nucleotides
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used, copied so that stateful policies start afresh for every file
+ * @param fmh hash function whose hashes are stored in the sketch
+ * @return hash_sketch containing the hashes of the kmers sketched from the strings
+ */
+template <sketching_policy policy_t>
+hash_sketch hash_sketch_from_nucleotide_strings(
+    const std::vector<acgt_string> &nucleotide_strings,
+    const kmer_bitset &mask,
+    const int window_length,
+    policy_t policy,
+    const frac_min_hash &fmh)
+{
+    hash_sketch hs;
+    sorted_hash_sink sink(fmh, hs.hashes);
+    nucleotide_string_list_to_sink(sink, nucleotide_strings, mask, window_length, policy);
+    sink.finish();
+    policy.finalise(hs);
+    return hs;
+}
+
+/**
+ * @brief
+ * Multi-mask version of hash_sketch_from_nucleotide_strings: sketches the strings under several masks
+ * sharing one window length in a single pass
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param nucleotide_strings list of ACGT strings representing the ACGT nucleotides
+ * @param masks spaced seed masks used
+ * @param window_length window size of the kmers
+ * @param policy sketching policy deciding which kmers are used, copied for every mask
+ * @param fmh hash function whose hashes are stored in the sketches
+ * @return one hash_sketch per mask, in the order of masks
+ */
+template <sketching_policy policy_t>
+std::vector<hash_sketch> hash_sketches_from_nucleotide_strings(
+    const std::vector<acgt_string> &nucleotide_strings,
+    const std::vector<kmer_bitset> &masks,
+    const int window_length,
+    const policy_t &policy,
+    const frac_min_hash &fmh)
+{
+    std::vector<hash_sketch> hash_sketches(masks.size());
+    std::vector<sorted_hash_sink> sinks;
+    for (hash_sketch &hs : hash_sketches)
+        sinks.emplace_back(fmh, hs.hashes);
+    std::vector<policy_t> policies(masks.size(), policy);
+
+    nucleotide_string_list_to_sinks(sinks, nucleotide_strings, masks, window_length, policies);
+    for (size_t m = 0; m < masks.size(); ++m)
+    {
+        sinks[m].finish();
+        policies[m].finalise(hash_sketches[m]);
+    }
+    return hash_sketches;
+}
+
+/**
+ * @brief
+ * Helper function that generates a hash_sketch from a .fasta file
+ * The hashes are collected as the kmers are found, then sorted once
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param fasta_filename path to the .fasta file to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used, copied so that stateful policies start afresh for every file
+ * @param fmh hash function whose hashes are stored in the sketch
+ * @return hash_sketch containing the hashes of the kmers sketched from that file
+ */
+template <sketching_policy policy_t>
+hash_sketch hash_sketch_from_fasta_file(
+    const char fasta_filename[],
+    const kmer_bitset &mask,
+    const int window_length,
+    policy_t policy,
+    const frac_min_hash &fmh)
+{
+    return hash_sketch_from_nucleotide_strings(
+        nucleotide_strings_from_fasta_file(fasta_filename),
+        mask,
+        window_length,
+        policy,
+        fmh);
+}
+
+/**
+ * @brief
+ * Parallel version of hash_sketch_from_fasta_file, which splits the file between workers
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param fasta_filename path to the .fasta file to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ * @param fmh hash function whose hashes are stored in the sketch
+ * @param chunk_length number of kmer windows sketched by one worker
+ * @return hash_sketch containing the hashes of the kmers sketched from that file
+ */
+template <sketching_policy policy_t>
+hash_sketch parallel_hash_sketch_from_fasta_file(
+    const char fasta_filename[],
+    const kmer_bitset &mask,
+    const int window_length,
+    const policy_t &policy,
+    const frac_min_hash &fmh,
+    const size_t chunk_length = DEFAULT_SKETCH_CHUNK_LENGTH)
+{
+    return chunked_sketch_nucleotide_strings(
+        nucleotide_strings_from_fasta_file(fasta_filename),
+        mask,
+        window_length,
+        policy,
+        hash_sketch(),
+        [&](hash_sketch &hs)
+        { return sorted_hash_sink(fmh, hs.hashes); },
+        chunk_length);
+}
+
+/**
+ * @brief
+ * Counts the kmers of a list of ACGT strings into an abundance_sketch, in parallel over chunks of the strings
+ * Every chunk is counted into its own abundance_sketch, and the chunk counts are added up at the end,
+ * so the workers never share a counter
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param nucleotide_strings list of ACGT strings representing the ACGT nucleotides
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are counted
+ * @param fmh hash function whose hashes are stored in the sketch
+ * @param chunk_length number of kmer windows counted by one worker
+ * @return abundance_sketch containing the hashes of the kmers sketched from the strings and their counts
+ */
+template <sketching_policy policy_t>
+abundance_sketch parallel_abundance_sketch_from_nucleotide_strings(
+    const std::vector<acgt_string> &nucleotide_strings,
+    const kmer_bitset &mask,
+    const int window_length,
+    const policy_t &policy,
+    const frac_min_hash &fmh,
+    const size_t chunk_length = DEFAULT_SKETCH_CHUNK_LENGTH)
+{
+    return chunked_sketch_nucleotide_strings(
+        nucleotide_strings,
+        mask,
+        window_length,
+        policy,
+        abundance_sketch(),
+        [&](abundance_sketch &as)
+        { return abundance_sink(fmh, as); },
+        chunk_length);
+}
+
+/**
+ * @brief
+ * Counts the kmers of a .fasta file (or of a read set in .fasta format) into an abundance_sketch,
+ * in parallel over chunks of the file
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param fasta_filename path to the .fasta file to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are counted
+ * @param fmh hash function whose hashes are stored in the sketch
+ * @param chunk_length number of kmer windows counted by one worker
+ * @return abundance_sketch containing the hashes of the kmers sketched from that file and their counts
+ */
+template <sketching_policy policy_t>
+abundance_sketch parallel_abundance_sketch_from_fasta_file(
+    const char fasta_filename[],
+    const kmer_bitset &mask,
+    const int window_length,
+    const policy_t &policy,
+    const frac_min_hash &fmh,
+    const size_t chunk_length = DEFAULT_SKETCH_CHUNK_LENGTH)
+{
+    return parallel_abundance_sketch_from_nucleotide_strings(
+        nucleotide_strings_from_fasta_file(fasta_filename),
+        mask,
+        window_length,
+        policy,
+        fmh,
+        chunk_length);
+}
+
+/**
+ * @brief
+ * Iterates over a list of filenames and creates a hash_sketch for each file
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param num_files number of files to be processed
+ * @param fasta_filenames pointer to the list of file names to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ * @param fmh hash function whose hashes are stored in the sketches
+ * @return a list of hash_sketches corresponding to the file names given
+ */
+template <sketching_policy policy_t>
+std::vector<hash_sketch> hash_sketches_from_fasta_files(
+    const int num_files,
+    char *fasta_filenames[],
+    const kmer_bitset &mask,
+    const int window_length,
+    const policy_t &policy,
+    const frac_min_hash &fmh)
+{
+    std::vector<hash_sketch> hash_sketches(num_files);
+    for (int i = 0; i < num_files; ++i)
+    {
+        hash_sketches[i] = hash_sketch_from_fasta_file(
+            fasta_filenames[i],
+            mask,
+            window_length,
+            policy,
+            fmh);
+    }
+    return hash_sketches;
+}
+
+/**
+ * @brief
+ * Parallel version of hash_sketches_from_fasta_files
+ * Uses a parallel_for over the fasta files, whose chunks run on the same workers
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param num_files number of files to be processed
+ * @param fasta_filenames pointer to the list of filenames to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ * @param fmh hash function whose hashes are stored in the sketches
+ * @return a list of hash_sketches corresponding to the file names given
+ */
+template <sketching_policy policy_t>
+std::vector<hash_sketch> parallel_hash_sketches_from_fasta_files(
+    const int num_files,
+    char *fasta_filenames[],
+    const kmer_bitset &mask,
+    const int window_length,
+    const policy_t &policy,
+    const frac_min_hash &fmh)
+{
+    // Debug: If the PARALLEL_DISABLE flag is set to 0, use the serial version
+    if (PARALLEL_DISABLE)
+        return hash_sketches_from_fasta_files(num_files, fasta_filenames, mask, window_length, policy, fmh);
+
+    // Large files are also split between workers, so a few large files do not leave the other workers idle
+    std::vector<hash_sketch> hash_sketches(num_files);
+    parallel_for(
+        0,
+        num_files,
+        [&](const int i)
+        {
+            hash_sketches[i] = parallel_hash_sketch_from_fasta_file(
+                fasta_filenames[i],
+                mask,
+                window_length,
+                policy,
+                fmh);
+        });
+    return hash_sketches;
+}
+
+/**
+ * @brief
+ * Helper function that generates a flat_kmer_set from a .fasta file
+ *
+ * @tparam code_t kmer word type of the codes stored in the set, must hold 2k bits
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param fasta_filename path to the .fasta file to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used, copied so that stateful policies start afresh for every file
+ * @param max_load_factor maximum fraction of slots in use in the set
+ * @return flat_kmer_set containing the kmers sketched from that file
+ */
+template <typename code_t, sketching_policy policy_t>
+flat_kmer_set<code_t> flat_kmer_set_from_fasta_file(
+    const char fasta_filename[],
+    const kmer_bitset &mask,
+    const int window_length,
+    policy_t policy,
+    const double max_load_factor = DEFAULT_FLAT_KMER_SET_LOAD_FACTOR)
+{
+    if ((int)mask.count() > kmer_word_bits<code_t>)
+        throw std::runtime_error("Given mask does not fit in the code type of the flat_kmer_set");
+
+    flat_kmer_set<code_t> fs(max_load_factor);
+    flat_kmer_set_sink<code_t> sink(fs);
+    sketch_fasta_file(sink, fasta_filename, mask, window_length, policy);
+    sink.finish();
+    policy.finalise(fs);
+    return fs;
+}
+
+/**
+ * @brief
+ * Parallel version of flat_kmer_set_from_fasta_file, which splits the file between workers
+ *
+ * @tparam code_t kmer word type of the codes stored in the set, must hold 2k bits
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param fasta_filename path to the .fasta file to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ * @param max_load_factor maximum fraction of slots in use in the set
+ * @param chunk_length number of kmer windows sketched by one worker
+ * @return flat_kmer_set containing the kmers sketched from that file
+ */
+template <typename code_t, sketching_policy policy_t>
+flat_kmer_set<code_t> parallel_flat_kmer_set_from_fasta_file(
+    const char fasta_filename[],
+    const kmer_bitset &mask,
+    const int window_length,
+    const policy_t &policy,
+    const double max_load_factor = DEFAULT_FLAT_KMER_SET_LOAD_FACTOR,
+    const size_t chunk_length = DEFAULT_SKETCH_CHUNK_LENGTH)
+{
+    if ((int)mask.count() > kmer_word_bits<code_t>)
+        throw std::runtime_error("Given mask does not fit in the code type of the flat_kmer_set");
+
+    return chunked_sketch_nucleotide_strings(
+        nucleotide_strings_from_fasta_file(fasta_filename),
+        mask,
+        window_length,
+        policy,
+        flat_kmer_set<code_t>(max_load_factor),
+        [](flat_kmer_set<code_t> &fs)
+        { return flat_kmer_set_sink<code_t>(fs); },
+        chunk_length);
+}
+
+/**
+ * @brief
+ * Parallel version of flat_kmer_set_from_fasta_file over a list of files
+ * Uses a parallel_for over the fasta files, whose chunks run on the same workers
+ *
+ * @tparam code_t kmer word type of the codes stored in the sets, must hold 2k bits
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param num_files number of files to be processed
+ * @param fasta_filenames pointer to the list of filenames to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ * @param max_load_factor maximum fraction of slots in use in the sets
+ * @return a list of flat_kmer_sets corresponding to the file names given
+ */
+template <typename code_t, sketching_policy policy_t>
+std::vector<flat_kmer_set<code_t>> parallel_flat_kmer_sets_from_fasta_files(
+    const int num_files,
+    char *fasta_filenames[],
+    const kmer_bitset &mask,
+    const int window_length,
+    const policy_t &policy,
+    const double max_load_factor = DEFAULT_FLAT_KMER_SET_LOAD_FACTOR)
+{
+    std::vector<flat_kmer_set<code_t>> flat_kmer_sets(num_files, flat_kmer_set<code_t>(max_load_factor));
+    if (PARALLEL_DISABLE)
+    {
+        for (int i = 0; i < num_files; ++i)
+            flat_kmer_sets[i] = flat_kmer_set_from_fasta_file<code_t>(fasta_filenames[i], mask, window_length, policy, max_load_factor);
+        return flat_kmer_sets;
+    }
+
+    // Large files are also split between workers, so a few large files do not leave the other workers idle
+    parallel_for(
+        0,
+        num_files,
+        [&](const int i)
+        {
+            flat_kmer_sets[i] = parallel_flat_kmer_set_from_fasta_file<code_t>(
+                fasta_filenames[i],
+                mask,
+                window_length,
+                policy,
+                max_load_factor);
+        });
+    return flat_kmer_sets;
+}
+
+#endif
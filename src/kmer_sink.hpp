@@ -0,0 +1,232 @@
+/**
+ * @file kmer_sink.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the kmer sinks, which receive the accepted kmers straight from the sliding window
+ * so that no intermediate list of kmers has to be built
+ *
+ * Every sink provides:
+ *  add(kmer) : called once for every accepted window (the same kmer may be added more than once)
+ *  finish()  : called by the owner of the sink once all the kmers have been added
+ */
+#ifndef KMER_SINK_HPP
+#define KMER_SINK_HPP
+#include "kmer.hpp"
+#include "flat_kmer_set.hpp"
+#include "hash_sketch.hpp"
+#include "abundance_sketch.hpp"
+
+/**
+ * @brief
+ * Requirements on a kmer sink (see the top of this file)
+ */
+template <typename sink_t>
+concept kmer_sink = requires(sink_t &sink, const kmer &k) {
+    sink.add(k);
+    sink.finish();
+};
+
+/**
+ * @brief
+ * Appends the kmers to a list of kmers, in the order they are found
+ *
+ * @param kmer_list list of kmers to append to
+ */
+struct kmer_list_sink
+{
+    std::vector<kmer> &kmer_list;
+
+    explicit kmer_list_sink(std::vector<kmer> &kmer_list) : kmer_list(kmer_list) {}
+
+    inline void add(const kmer &k)
+    {
+        kmer_list.push_back(k);
+    }
+
+    inline void finish() {}
+};
+
+/**
+ * @brief
+ * Inserts the kmers into a kmer_set
+ *
+ * @param ks kmer_set to insert into
+ */
+struct kmer_set_sink
+{
+    kmer_set &ks;
+
+    explicit kmer_set_sink(kmer_set &ks) : ks(ks) {}
+
+    inline void add(const kmer &k)
+    {
+        ks.insert_kmer(k);
+    }
+
+    inline void finish() {}
+};
+
+/**
+ * @brief
+ * Inserts the compacted codes of the kmers into a flat_kmer_set
+ *
+ * @tparam code_t kmer word type of the codes stored in the set
+ * @param fs flat_kmer_set to insert into
+ */
+template <typename code_t>
+struct flat_kmer_set_sink
+{
+    flat_kmer_set<code_t> &fs;
+
+    explicit flat_kmer_set_sink(flat_kmer_set<code_t> &fs) : fs(fs) {}
+
+    inline void add(const kmer &k)
+    {
+        fs.insert_kmer(k);
+    }
+
+    inline void finish() {}
+};
+
+/**
+ * @brief
+ * Collects the hashes of the kmers into a buffer, which finish() sorts and deduplicates
+ * The buffer only holds 8 bytes per kmer, so it is much smaller than a kmer_set of the same kmers
+ *
+ * @param fmh hash function
+ * @param hashes buffer of hashes, sorted and without duplicates after finish()
+ */
+struct sorted_hash_sink
+{
+    frac_min_hash fmh;
+    std::vector<uint64_t> &hashes;
+
+    sorted_hash_sink(const frac_min_hash &fmh, std::vector<uint64_t> &hashes) : fmh(fmh), hashes(hashes) {}
+
+    inline void add(const kmer &k)
+    {
+        hashes.push_back(fmh(k));
+    }
+
+    inline void finish()
+    {
+        std::sort(hashes.begin(), hashes.end());
+        hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    }
+};
+
+/**
+ * @brief
+ * Counts the occurrences of every kmer: the hash of every kmer added is collected into a buffer,
+ * which finish() sorts and turns into distinct hashes and their counts
+ * Every chunk of a file gets its own sink when counted in parallel, so the counts are thread-local
+ *
+ * @param fmh hash function
+ * @param as abundance sketch receiving the hashes, which must be empty before the first kmer is added
+ */
+struct abundance_sink
+{
+    frac_min_hash fmh;
+    abundance_sketch &as;
+
+    abundance_sink(const frac_min_hash &fmh, abundance_sketch &as) : fmh(fmh), as(as) {}
+
+    inline void add(const kmer &k)
+    {
+        as.hashes.push_back(fmh(k));
+    }
+
+    inline void finish()
+    {
+        count_sorted_hashes(as.hashes, as.counts);
+    }
+};
+
+/**
+ * @brief
+ * Keeps the hashes of the sketch_size kmers with the smallest hashes, in a buffer of at most 2 * sketch_size hashes
+ * Whenever the buffer fills up, it is cut back to the sketch_size smallest distinct hashes, and larger hashes
+ * are rejected from then on, so the memory is fixed whatever the length of the genome
+ *
+ * @param fmh hash function
+ * @param sketch_size number of hashes kept (k)
+ * @param hashes buffer of hashes, holding the sketch_size smallest distinct hashes, sorted, after finish()
+ * @param threshold hashes at or above it are rejected
+ */
+struct bottom_k_sink
+{
+    frac_min_hash fmh;
+    size_t sketch_size;
+    std::vector<uint64_t> &hashes;
+    uint64_t threshold = UINT64_MAX;
+
+    bottom_k_sink(const frac_min_hash &fmh, const size_t sketch_size, std::vector<uint64_t> &hashes)
+        : fmh(fmh), sketch_size(sketch_size), hashes(hashes)
+    {
+        hashes.reserve(2 * sketch_size);
+    }
+
+    inline void add(const kmer &k)
+    {
+        const uint64_t hash = fmh(k);
+        if (hash >= threshold || sketch_size == 0)
+            return;
+        hashes.push_back(hash);
+        if (hashes.size() >= 2 * sketch_size)
+            cut_to_bottom_k(hashes, sketch_size, threshold);
+    }
+
+    inline void finish()
+    {
+        cut_to_bottom_k(hashes, sketch_size, threshold);
+    }
+};
+
+/**
+ * @brief
+ * Only counts the kmers, without storing them
+ *
+ * @param num_kmers number of kmers added, counting repeated kmers every time
+ */
+struct kmer_counter_sink
+{
+    size_t num_kmers = 0;
+
+    inline void add(const kmer &)
+    {
+        ++num_kmers;
+    }
+
+    inline void finish() {}
+};
+
+/**
+ * @brief
+ * Writes the hash of every kmer to an output stream, one per line
+ *
+ * @param fmh hash function
+ * @param output_stream stream the hashes are written to
+ */
+struct kmer_file_sink
+{
+    frac_min_hash fmh;
+    std::ostream &output_stream;
+
+    kmer_file_sink(const frac_min_hash &fmh, std::ostream &output_stream) : fmh(fmh), output_stream(output_stream) {}
+
+    inline void add(const kmer &k)
+    {
+        output_stream << fmh(k) << '\n';
+    }
+
+    inline void finish()
+    {
+        output_stream.flush();
+    }
+};
+
+#endif
@@ -0,0 +1,585 @@
+/**
+ * @file kmer_sliding.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the templated sliding window engine over fixed-width kmer words
+ * The word type is picked at runtime from the window length by dispatch_kmer_word,
+ * so each window length runs on the narrowest instantiation that fits
+ */
+#ifndef KMER_SLIDING_HPP
+#define KMER_SLIDING_HPP
+#include "kmer.hpp"
+#include "sketching_policy.hpp"
+#include "kmer_sink.hpp"
+
+constexpr int SLIDING_DEBUG = DEBUG | 0;
+
+/**
+ * @brief
+ * State of the sliding window over the main strand and the complement strand
+ * The main strand holds the newest nucleotide in its lowest bits,
+ * the complement strand holds the complement of the newest nucleotide in the highest bits of the window,
+ * so that the complement strand reads as the reverse complement of the main strand
+ *
+ * @tparam word_t fixed-width word type holding the window
+ * @param main_strand bits of the current window on the main strand (bits above the window are not cleared)
+ * @param complement_strand bits of the current window on the reverse complement strand
+ * @param window_bits word with exactly the lowest NUCLEOTIDE_BIT_SIZE * window_length bits set
+ * @param complement_top complement of each nucleotide, shifted to the top of the window
+ */
+template <typename word_t>
+struct kmer_window
+{
+    word_t main_strand = 0;
+    word_t complement_strand = 0;
+    word_t window_bits;
+    word_t complement_top[4];
+
+    explicit kmer_window(const int window_length)
+        : window_bits(low_bits_kmer_word<word_t>(NUCLEOTIDE_BIT_SIZE * window_length))
+    {
+        for (uint8_t nucleotide_bits = 0; nucleotide_bits < 4; ++nucleotide_bits)
+        {
+            // nucleotide_bits ^ 0x3 computes the complementary nucleotide
+            complement_top[nucleotide_bits] = word_t(nucleotide_bits ^ 0x3) << (NUCLEOTIDE_BIT_SIZE * (window_length - 1));
+        }
+    }
+
+    /**
+     * @brief
+     * Shifts the main strand to the LEFT and the complement strand to the RIGHT by one nucleotide,
+     * and adds the new nucleotide to both
+     *
+     * @param nucleotide_bits The nucleotide bits of the current nucleotide
+     */
+    inline void push(const uint8_t nucleotide_bits)
+    {
+        main_strand = (main_strand << NUCLEOTIDE_BIT_SIZE) | word_t(nucleotide_bits);
+        complement_strand = (complement_strand >> NUCLEOTIDE_BIT_SIZE) | complement_top[nucleotide_bits];
+    }
+};
+
+/**
+ * @brief
+ * Calls f with a value of the narrowest kmer word type that can hold a window of the given length
+ * f is instantiated for every word type, so it should be a generic lambda taking the word by value
+ *
+ * @param window_length length of the kmer window
+ * @param f callable taking a kmer word (only its type matters)
+ */
+template <typename word_callable>
+inline void dispatch_kmer_word(const int window_length, word_callable &&f)
+{
+    if (window_length <= 32)
+        f(uint64_t(0));
+    else if (window_length <= 64)
+        f(uint128_word(0));
+    else if (window_length <= MAX_KMER_LENGTH)
+        f(kmer_code(0));
+    else
+        throw std::runtime_error("Given window length exceeds maximum k-mer length");
+}
+
+/**
+ * @brief
+ * Spaced seed prepared for a particular window word type
+ *
+ * @tparam word_t fixed-width word type holding the window
+ * @param window_length window size of the kmer
+ * @param kmer_length number of nucleotides used by the mask (k)
+ * @param mask spaced seed mask, restricted to the window
+ * @param mask_code spaced seed mask as stored in kmer records
+ * @param compactor plan for compacting masked windows into 2k-bit codes
+ */
+template <typename word_t>
+struct spaced_seed
+{
+    typedef word_t word_type;
+
+    int window_length;
+    int kmer_length;
+    word_t mask;
+    kmer_code mask_code;
+    spaced_seed_compactor<word_t> compactor;
+
+    spaced_seed(const kmer_bitset &mask_bits, const int window_length)
+        : window_length(window_length),
+          mask(kmer_word_from_bitset<word_t>(mask_bits) & low_bits_kmer_word<word_t>(NUCLEOTIDE_BIT_SIZE * window_length)),
+          mask_code(convert_kmer_word<kmer_code>(mask)),
+          compactor(mask)
+    {
+        kmer_length = (kmer_word_popcount(mask) + 1) / NUCLEOTIDE_BIT_SIZE;
+    }
+};
+
+/**
+ * @brief
+ * Prepares a spaced seed for the narrowest window word type that fits the window length,
+ * and calls f with it and a value of the narrowest code word type that fits the compacted kmers
+ * f is instantiated for every valid pair of word types, so it should be a generic lambda
+ * Bits of the mask outside the window are ignored
+ *
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param f callable taking a const spaced_seed<word_t> & and a code word (only its type matters)
+ */
+template <typename seed_callable>
+inline void dispatch_spaced_seed(const kmer_bitset &mask, const int window_length, seed_callable &&f)
+{
+    dispatch_kmer_word(
+        window_length,
+        [&](auto word_tag)
+        {
+            typedef decltype(word_tag) word_t;
+            const spaced_seed<word_t> seed(mask, window_length);
+            dispatch_kmer_word(
+                seed.kmer_length,
+                [&](auto code_tag)
+                {
+                    typedef decltype(code_tag) code_t;
+
+                    // The compacted code is never wider than the window
+                    if constexpr (kmer_word_bits<code_t> <= kmer_word_bits<word_t>)
+                        f(seed, code_tag);
+                });
+        });
+}
+
+/**
+ * @brief
+ * Multi-mask version of dispatch_spaced_seed, for masks sharing one window length
+ * The code word type is the narrowest that fits the longest kmer, and since hashes do not depend on the word type
+ * every mask gives the same hashes as it would on its own
+ *
+ * @param masks spaced seed masks used
+ * @param window_length window size of the kmers
+ * @param f callable taking a const std::vector<spaced_seed<word_t>> & (one seed per mask) and a code word (only its type matters)
+ */
+template <typename seeds_callable>
+inline void dispatch_multi_spaced_seed(const std::vector<kmer_bitset> &masks, const int window_length, seeds_callable &&f)
+{
+    dispatch_kmer_word(
+        window_length,
+        [&](auto word_tag)
+        {
+            typedef decltype(word_tag) word_t;
+            std::vector<spaced_seed<word_t>> seeds;
+            int max_kmer_length = 0;
+            for (const kmer_bitset &mask : masks)
+            {
+                seeds.emplace_back(mask, window_length);
+                max_kmer_length = std::max(max_kmer_length, seeds.back().kmer_length);
+            }
+            dispatch_kmer_word(
+                max_kmer_length,
+                [&](auto code_tag)
+                {
+                    typedef decltype(code_tag) code_t;
+
+                    // The compacted code is never wider than the window
+                    if constexpr (kmer_word_bits<code_t> <= kmer_word_bits<word_t>)
+                        f(seeds, code_tag);
+                });
+        });
+}
+
+/**
+ * @brief
+ * Slides a kmer window across the nucleotides [start_idx, end_idx) of an ACGT string and calls on_window on every full window
+ * Consecutive ranges must overlap by window_length - 1 nucleotides for every window to be visited exactly once
+ *
+ * @tparam word_t fixed-width word type holding the window
+ * @param nucleotide_string ACGT string representing the ACGT nucleotides
+ * @param window_length window size of the kmer
+ * @param start_idx index of the first nucleotide in the range
+ * @param end_idx index one past the last nucleotide in the range, at most nucleotide_string.size()
+ * @param on_window callable taking a const kmer_window<word_t> &
+ */
+template <typename word_t, typename window_callable>
+inline void for_each_kmer_window(
+    const acgt_string &nucleotide_string,
+    const int window_length,
+    const size_t start_idx,
+    const size_t end_idx,
+    window_callable &&on_window)
+{
+    // If the range is too short, no kmers in this range
+    if (end_idx < start_idx + window_length)
+    {
+        return;
+    }
+
+    kmer_window<word_t> window(window_length);
+
+    // Read the nucleotides a packed word at a time
+    acgt_string_reader reader(nucleotide_string, start_idx);
+
+    // Create the first kmer window
+    for (int idx = 0; idx + 1 < window_length; ++idx)
+    {
+        window.push(reader.next());
+    }
+
+    // Shift the window by one each time and visit each new window
+    for (size_t idx = start_idx + window_length - 1; idx < end_idx; ++idx)
+    {
+        window.push(reader.next());
+        on_window(window);
+    }
+}
+
+/**
+ * @brief
+ * Slides a kmer window across an ACGT string and calls on_window on every full window
+ *
+ * @tparam word_t fixed-width word type holding the window
+ * @param nucleotide_string ACGT string representing the ACGT nucleotides
+ * @param window_length window size of the kmer
+ * @param on_window callable taking a const kmer_window<word_t> &
+ */
+template <typename word_t, typename window_callable>
+inline void for_each_kmer_window(
+    const acgt_string &nucleotide_string,
+    const int window_length,
+    window_callable &&on_window)
+{
+    for_each_kmer_window<word_t>(nucleotide_string, window_length, 0, nucleotide_string.size(), on_window);
+}
+
+/**
+ * @brief
+ * Slides a kmer window across the nucleotides [start_idx, end_idx) of an ACGT string
+ * and calls on_kmer with the canonical compacted code of every window
+ * The canonical kmer is the smaller of the two masked strands (using the same mask on the reverse complement strand),
+ * compacted into a dense 2k-bit code
+ *
+ * @tparam code_t fixed-width word type holding the compacted kmer
+ * @tparam word_t fixed-width word type holding the window
+ * @param nucleotide_string ACGT string representing the ACGT nucleotides
+ * @param seed spaced seed used, prepared for word_t
+ * @param start_idx index of the first nucleotide in the range
+ * @param end_idx index one past the last nucleotide in the range
+ * @param on_kmer callable taking (const kmer_window<word_t> &window, const code_t &canonical_code, bool main_strand_is_canonical)
+ */
+template <typename code_t, typename word_t, typename kmer_callable>
+inline void for_each_canonical_kmer(
+    const acgt_string &nucleotide_string,
+    const spaced_seed<word_t> &seed,
+    const size_t start_idx,
+    const size_t end_idx,
+    kmer_callable &&on_kmer)
+{
+    for_each_kmer_window<word_t>(
+        nucleotide_string,
+        seed.window_length,
+        start_idx,
+        end_idx,
+        [&](const kmer_window<word_t> &window)
+        {
+            // Compute the masked kmers for both the main strand and the complement strand
+            const word_t masked_main_strand = window.main_strand & seed.mask;
+            const word_t masked_reverse_complement_strand = window.complement_strand & seed.mask; // use the same mask on the reverse complement strand
+
+            // Determine the canonical kmer by lexicographical comparison of the main strand and the reverse complement
+            // Compaction preserves order, so only the canonical strand needs to be compacted
+            const bool main_strand_is_canonical = masked_main_strand < masked_reverse_complement_strand;
+            const code_t canonical_code = seed.compactor.template compact<code_t>(
+                main_strand_is_canonical ? masked_main_strand : masked_reverse_complement_strand);
+            on_kmer(window, canonical_code, main_strand_is_canonical);
+        });
+}
+
+/**
+ * @brief
+ * Number of windows slid at a time by for_each_canonical_kmer_multi before the masks are applied to them
+ */
+constexpr size_t MULTI_MASK_BLOCK_LENGTH = 256;
+
+/**
+ * @brief
+ * Multi-mask version of for_each_canonical_kmer: the window slides once, and every mask is applied to each window
+ * The windows are slid a block at a time into a buffer, then each mask runs over the whole block,
+ * so the inner loop keeps one mask and compaction plan in registers as in the single-mask version
+ * The kmers of each mask are found in order, but the kmers of different masks are interleaved block by block
+ *
+ * @tparam code_t fixed-width word type holding the compacted kmers
+ * @tparam word_t fixed-width word type holding the window
+ * @param nucleotide_string ACGT string representing the ACGT nucleotides
+ * @param seeds spaced seeds used, prepared for word_t, all with the same window length
+ * @param start_idx index of the first nucleotide in the range
+ * @param end_idx index one past the last nucleotide in the range
+ * @param on_kmer callable taking (size_t seed_idx, const kmer_window<word_t> &window, const code_t &canonical_code, bool main_strand_is_canonical)
+ */
+template <typename code_t, typename word_t, typename kmer_callable>
+inline void for_each_canonical_kmer_multi(
+    const acgt_string &nucleotide_string,
+    const std::vector<spaced_seed<word_t>> &seeds,
+    const size_t start_idx,
+    const size_t end_idx,
+    kmer_callable &&on_kmer)
+{
+    if (seeds.empty())
+        return;
+    const int window_length = seeds.front().window_length;
+
+    // If the range is too short, no kmers in this range
+    if (end_idx < start_idx + window_length)
+        return;
+
+    kmer_window<word_t> window(window_length);
+    acgt_string_reader reader(nucleotide_string, start_idx);
+    for (int idx = 0; idx + 1 < window_length; ++idx)
+    {
+        window.push(reader.next());
+    }
+
+    word_t main_strands[MULTI_MASK_BLOCK_LENGTH];
+    word_t complement_strands[MULTI_MASK_BLOCK_LENGTH];
+    kmer_window<word_t> block_window = window;
+    for (size_t block_idx = start_idx + window_length - 1; block_idx < end_idx; block_idx += MULTI_MASK_BLOCK_LENGTH)
+    {
+        const size_t block_length = std::min(MULTI_MASK_BLOCK_LENGTH, end_idx - block_idx);
+        for (size_t j = 0; j < block_length; ++j)
+        {
+            window.push(reader.next());
+            main_strands[j] = window.main_strand;
+            complement_strands[j] = window.complement_strand;
+        }
+
+        for (size_t seed_idx = 0; seed_idx < seeds.size(); ++seed_idx)
+        {
+            const spaced_seed<word_t> &seed = seeds[seed_idx];
+            for (size_t j = 0; j < block_length; ++j)
+            {
+                const word_t masked_main_strand = main_strands[j] & seed.mask;
+                const word_t masked_reverse_complement_strand = complement_strands[j] & seed.mask;
+                const bool main_strand_is_canonical = masked_main_strand < masked_reverse_complement_strand;
+                const code_t canonical_code = seed.compactor.template compact<code_t>(
+                    main_strand_is_canonical ? masked_main_strand : masked_reverse_complement_strand);
+                block_window.main_strand = main_strands[j];
+                block_window.complement_strand = complement_strands[j];
+                on_kmer(seed_idx, block_window, canonical_code, main_strand_is_canonical);
+            }
+        }
+    }
+}
+
+/**
+ * @brief
+ * Builds the kmer record for a canonical kmer found by for_each_canonical_kmer
+ *
+ * @param seed spaced seed used
+ * @param window current window
+ * @param canonical_code compacted canonical kmer
+ * @param main_strand_is_canonical whether the canonical kmer is on the main strand
+ * @return kmer record
+ */
+template <typename word_t, typename code_t>
+inline kmer make_canonical_kmer(
+    const spaced_seed<word_t> &seed,
+    const kmer_window<word_t> &window,
+    const code_t &canonical_code,
+    const bool main_strand_is_canonical)
+{
+    const word_t canonical_kmer_bits = main_strand_is_canonical ? (window.main_strand & window.window_bits) : window.complement_strand;
+    return kmer(
+        seed.window_length,
+        convert_kmer_word<kmer_code>(canonical_kmer_bits),
+        seed.mask_code,
+        convert_kmer_word<kmer_code>(canonical_code));
+}
+
+/**
+ * @brief
+ * Function to convert the nucleotides [start_idx, end_idx) of an ACGT string into kmers, which are passed straight to a sink
+ * Uses a sliding window with a fixed-width word representing the current window in order to efficiently compute the current canonical kmer
+ * Implicitly constructs the complement strand of nucleotide_string in order to efficiently compute the reverse complement
+ * The policy tests the compacted canonical code first, so a kmer is only built for the windows that pass it
+ *
+ * @tparam word_t fixed-width word type holding the window
+ * @tparam code_t fixed-width word type holding the compacted kmer
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @tparam sink_t kmer sink (see kmer_sink.hpp)
+ * @param sink sink receiving the accepted kmers
+ * @param nucleotide_string ACGT string representing the ACGT nucleotides
+ * @param seed spaced seed used, prepared for word_t
+ * @param policy sketching policy deciding which kmers are used
+ * @param start_idx index of the first nucleotide in the range to be sketched
+ * @param end_idx index one past the last nucleotide in the range to be sketched
+ */
+template <typename word_t, typename code_t, sketching_policy policy_t, kmer_sink sink_t>
+inline void nucleotide_string_to_kmers(
+    sink_t &sink,
+    const acgt_string &nucleotide_string,
+    const spaced_seed<word_t> &seed,
+    policy_t &policy,
+    const size_t start_idx,
+    const size_t end_idx)
+{
+    for_each_canonical_kmer<code_t>(
+        nucleotide_string,
+        seed,
+        start_idx,
+        end_idx,
+        [&](const kmer_window<word_t> &window, const code_t &canonical_code, const bool main_strand_is_canonical)
+        {
+            if (SLIDING_DEBUG)
+                std::cout << "Current kmer            :" << convert_kmer_word<kmer_code>(window.main_strand) << std::endl;
+            if (SLIDING_DEBUG)
+                std::cout << "Current complement kmer :" << convert_kmer_word<kmer_code>(window.complement_strand) << std::endl;
+
+            if (!policy.accept_code(canonical_code))
+                return;
+
+            const kmer canon_kmer = make_canonical_kmer(seed, window, canonical_code, main_strand_is_canonical);
+            if (policy.accept_kmer(canon_kmer))
+                sink.add(canon_kmer);
+        });
+}
+
+/**
+ * @brief
+ * Helper function to compute the kmers in a list of nucleotide strings and pass them straight to a sink
+ * The sink is not finished, so that several lists can be added to the same sink
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @tparam sink_t kmer sink (see kmer_sink.hpp)
+ * @param sink sink receiving the accepted kmers
+ * @param nucleotide_strings list of ACGT strings representing the ACGT nucleotides
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ */
+template <sketching_policy policy_t, kmer_sink sink_t>
+void nucleotide_string_list_to_sink(
+    sink_t &sink,
+    const std::vector<acgt_string> &nucleotide_strings,
+    const kmer_bitset &mask,
+    const int window_length,
+    policy_t &policy)
+{
+    // Pick the word types once for the whole list
+    dispatch_spaced_seed(
+        mask,
+        window_length,
+        [&](const auto &seed, auto code_tag)
+        {
+            typedef typename std::remove_cvref_t<decltype(seed)>::word_type word_t;
+            typedef decltype(code_tag) code_t;
+            for (acgt_string const &s : nucleotide_strings)
+            {
+                nucleotide_string_to_kmers<word_t, code_t>(sink, s, seed, policy, 0, s.size());
+            }
+        });
+}
+
+/**
+ * @brief
+ * Multi-mask version of nucleotide_string_list_to_sink: slides over the strings once and passes the kmers
+ * accepted for mask m to sinks[m], tested by policies[m]
+ * The masks must share window_length, sinks and policies must hold one entry per mask
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @tparam sink_t kmer sink (see kmer_sink.hpp)
+ * @param sinks sinks receiving the accepted kmers, one per mask
+ * @param nucleotide_strings list of ACGT strings representing the ACGT nucleotides
+ * @param masks spaced seed masks used
+ * @param window_length window size of the kmers
+ * @param policies sketching policies deciding which kmers are used, one per mask
+ */
+template <sketching_policy policy_t, kmer_sink sink_t>
+void nucleotide_string_list_to_sinks(
+    std::vector<sink_t> &sinks,
+    const std::vector<acgt_string> &nucleotide_strings,
+    const std::vector<kmer_bitset> &masks,
+    const int window_length,
+    std::vector<policy_t> &policies)
+{
+    if (sinks.size() != masks.size() || policies.size() != masks.size())
+        throw std::runtime_error("Multi-mask sketching needs one sink and one policy per mask");
+
+    dispatch_multi_spaced_seed(
+        masks,
+        window_length,
+        [&](const auto &seeds, auto code_tag)
+        {
+            typedef typename std::remove_cvref_t<decltype(seeds)>::value_type::word_type word_t;
+            typedef decltype(code_tag) code_t;
+            for (acgt_string const &s : nucleotide_strings)
+            {
+                for_each_canonical_kmer_multi<code_t>(
+                    s,
+                    seeds,
+                    0,
+                    s.size(),
+                    [&](const size_t seed_idx, const kmer_window<word_t> &window, const code_t &canonical_code, const bool main_strand_is_canonical)
+                    {
+                        if (!policies[seed_idx].accept_code(canonical_code))
+                            return;
+
+                        const kmer canon_kmer = make_canonical_kmer(seeds[seed_idx], window, canonical_code, main_strand_is_canonical);
+                        if (policies[seed_idx].accept_kmer(canon_kmer))
+                            sinks[seed_idx].add(canon_kmer);
+                    });
+            }
+        });
+}
+
+/**
+ * @brief
+ * Helper function to compute the kmers in a list of nucleotide strings
+ * This version computes by reference to avoid copying, appends the kmers to a given list of kmers
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param kmer_list reference to a list of kmers for appending new kmers
+ * @param nucleotide_strings list of ACGT strings representing the ACGT nucleotides
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ */
+template <sketching_policy policy_t>
+void nucleotide_string_list_to_kmers_by_reference(
+    std::vector<kmer> &kmer_list,
+    const std::vector<acgt_string> &nucleotide_strings,
+    const kmer_bitset &mask,
+    const int window_length,
+    policy_t &policy)
+{
+    kmer_list_sink sink(kmer_list);
+    nucleotide_string_list_to_sink(sink, nucleotide_strings, mask, window_length, policy);
+}
+
+/**
+ * @brief
+ * Helper function to compute the kmers in a list of nucleotide strings
+ * This version explicity returns a vector of kmers
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param nucleotide_strings list of ACGT strings representing the ACGT nucleotides
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ * @return returns a list of kmers in the nucleotide strings
+ */
+template <sketching_policy policy_t>
+std::vector<kmer> nucleotide_string_list_to_kmers(
+    const std::vector<acgt_string> &nucleotide_strings,
+    const kmer_bitset &mask,
+    const int window_length,
+    policy_t &policy)
+{
+    std::vector<kmer> return_kmers;
+    nucleotide_string_list_to_kmers_by_reference(
+        return_kmers,
+        nucleotide_strings,
+        mask,
+        window_length,
+        policy);
+    return return_kmers;
+}
+
+#endif
@@ -0,0 +1,443 @@
+/**
+ * @file kmer_word.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the fixed-width integer types used to hold kmer windows on the hot path,
+ * together with the handful of operations the sliding window needs on them.
+ * A window is held in uint64_t (up to 32 nucleotides), uint128_word (up to 64 nucleotides)
+ * or multi_word<N> (up to 32N nucleotides), all of which support the same operators
+ */
+#ifndef KMER_WORD_HPP
+#define KMER_WORD_HPP
+#include "stl_includes.hpp"
+
+#include <array>
+#include <bit>
+#include <boost/dynamic_bitset.hpp>
+#include <boost/functional/hash.hpp>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+typedef unsigned __int128 uint128_word;
+
+/**
+ * @brief
+ * Fixed-width integer made of NUM_WORDS 64-bit words, used for windows wider than 128 bits
+ * words[0] holds the least significant bits
+ *
+ * @tparam NUM_WORDS number of 64-bit words
+ * @param words the 64-bit words, least significant first
+ */
+template <int NUM_WORDS>
+struct multi_word
+{
+    std::array<uint64_t, NUM_WORDS> words{};
+
+    constexpr multi_word() = default;
+    constexpr multi_word(const uint64_t low) : words{low} {}
+
+    friend constexpr multi_word operator&(multi_word a, const multi_word &b)
+    {
+        for (int i = 0; i < NUM_WORDS; ++i)
+            a.words[i] &= b.words[i];
+        return a;
+    }
+
+    friend constexpr multi_word operator|(multi_word a, const multi_word &b)
+    {
+        for (int i = 0; i < NUM_WORDS; ++i)
+            a.words[i] |= b.words[i];
+        return a;
+    }
+
+    friend constexpr multi_word operator^(multi_word a, const multi_word &b)
+    {
+        for (int i = 0; i < NUM_WORDS; ++i)
+            a.words[i] ^= b.words[i];
+        return a;
+    }
+
+    friend constexpr multi_word operator~(multi_word a)
+    {
+        for (int i = 0; i < NUM_WORDS; ++i)
+            a.words[i] = ~a.words[i];
+        return a;
+    }
+
+    /**
+     * @brief
+     * Shifts towards the more significant bits, 0 <= shift < 64 * NUM_WORDS
+     */
+    friend constexpr multi_word operator<<(const multi_word &a, const int shift)
+    {
+        multi_word r;
+        const int word_shift = shift / 64, bit_shift = shift % 64;
+        for (int i = NUM_WORDS - 1; i >= word_shift; --i)
+        {
+            r.words[i] = a.words[i - word_shift] << bit_shift;
+            if (bit_shift != 0 && i - word_shift - 1 >= 0)
+                r.words[i] |= a.words[i - word_shift - 1] >> (64 - bit_shift);
+        }
+        return r;
+    }
+
+    /**
+     * @brief
+     * Shifts towards the less significant bits, 0 <= shift < 64 * NUM_WORDS
+     */
+    friend constexpr multi_word operator>>(const multi_word &a, const int shift)
+    {
+        multi_word r;
+        const int word_shift = shift / 64, bit_shift = shift % 64;
+        for (int i = 0; i + word_shift < NUM_WORDS; ++i)
+        {
+            r.words[i] = a.words[i + word_shift] >> bit_shift;
+            if (bit_shift != 0 && i + word_shift + 1 < NUM_WORDS)
+                r.words[i] |= a.words[i + word_shift + 1] << (64 - bit_shift);
+        }
+        return r;
+    }
+
+    constexpr multi_word &operator&=(const multi_word &b) { return *this = *this & b; }
+    constexpr multi_word &operator|=(const multi_word &b) { return *this = *this | b; }
+    constexpr multi_word &operator^=(const multi_word &b) { return *this = *this ^ b; }
+    constexpr multi_word &operator<<=(const int shift) { return *this = *this << shift; }
+    constexpr multi_word &operator>>=(const int shift) { return *this = *this >> shift; }
+
+    friend constexpr bool operator==(const multi_word &a, const multi_word &b) = default;
+
+    /**
+     * @brief
+     * Numerical comparison, most significant word first
+     */
+    friend constexpr bool operator<(const multi_word &a, const multi_word &b)
+    {
+        for (int i = NUM_WORDS - 1; i >= 0; --i)
+        {
+            if (a.words[i] != b.words[i])
+                return a.words[i] < b.words[i];
+        }
+        return false;
+    }
+
+    /**
+     * @brief
+     * Hash used by boost::hash (found through ADL)
+     */
+    friend size_t hash_value(const multi_word &w)
+    {
+        return boost::hash_range(w.words.begin(), w.words.end());
+    }
+
+    /**
+     * @brief
+     * Prints the bits most significant first, in the same format as boost::dynamic_bitset
+     */
+    friend std::ostream &operator<<(std::ostream &os, const multi_word &w)
+    {
+        for (int i = 64 * NUM_WORDS - 1; i >= 0; --i)
+            os << ((w.words[i / 64] >> (i % 64)) & 0x1);
+        return os;
+    }
+};
+
+/**
+ * @brief
+ * Number of bits in a kmer word type
+ */
+template <typename word_t>
+constexpr int kmer_word_bits = 8 * sizeof(word_t);
+
+/**
+ * @brief
+ * Number of 64-bit lanes in a kmer word type
+ */
+template <typename word_t>
+constexpr int kmer_word_lanes = sizeof(word_t) / sizeof(uint64_t);
+
+/**
+ * @brief
+ * Reads the 64-bit lane at index lane of a kmer word (lane 0 is least significant)
+ */
+inline uint64_t kmer_word_lane(const uint64_t &w, const int lane)
+{
+    return w;
+}
+inline uint64_t kmer_word_lane(const uint128_word &w, const int lane)
+{
+    return (uint64_t)(w >> (64 * lane));
+}
+template <int NUM_WORDS>
+inline uint64_t kmer_word_lane(const multi_word<NUM_WORDS> &w, const int lane)
+{
+    return w.words[lane];
+}
+
+/**
+ * @brief
+ * ORs a 64-bit value into the lane at index lane of a kmer word
+ */
+inline void or_kmer_word_lane(uint64_t &w, const int lane, const uint64_t value)
+{
+    w |= value;
+}
+inline void or_kmer_word_lane(uint128_word &w, const int lane, const uint64_t value)
+{
+    w |= (uint128_word)value << (64 * lane);
+}
+template <int NUM_WORDS>
+inline void or_kmer_word_lane(multi_word<NUM_WORDS> &w, const int lane, const uint64_t value)
+{
+    w.words[lane] |= value;
+}
+
+/**
+ * @brief
+ * Converts between two kmer word types lane by lane
+ * Lanes that do not exist in the source are 0, lanes that do not fit in the destination are dropped
+ *
+ * @tparam to_word_t destination word type
+ * @tparam from_word_t source word type
+ * @param w word to be converted
+ * @return converted word
+ */
+template <typename to_word_t, typename from_word_t>
+inline to_word_t convert_kmer_word(const from_word_t &w)
+{
+    to_word_t r = 0;
+    for (int lane = 0; lane < std::min(kmer_word_lanes<to_word_t>, kmer_word_lanes<from_word_t>); ++lane)
+        or_kmer_word_lane(r, lane, kmer_word_lane(w, lane));
+    return r;
+}
+
+/**
+ * @brief
+ * Converts a boost::dynamic_bitset into a kmer word, dropping any bits that do not fit
+ *
+ * @tparam word_t destination word type
+ * @param bits bitset to be converted
+ * @return kmer word with the same bits set
+ */
+template <typename word_t>
+inline word_t kmer_word_from_bitset(const boost::dynamic_bitset<> &bits)
+{
+    word_t w = 0;
+    for (size_t i = bits.find_first(); i != boost::dynamic_bitset<>::npos && i < (size_t)kmer_word_bits<word_t>; i = bits.find_next(i))
+        or_kmer_word_lane(w, i / 64, (uint64_t)1 << (i % 64));
+    return w;
+}
+
+/**
+ * @brief
+ * Kmer word with the lowest num_bits bits set, 0 <= num_bits <= kmer_word_bits<word_t>
+ */
+template <typename word_t>
+inline word_t low_bits_kmer_word(const int num_bits)
+{
+    word_t w = 0;
+    for (int lane = 0; lane * 64 < num_bits; ++lane)
+        or_kmer_word_lane(w, lane, (num_bits - lane * 64 >= 64) ? ~(uint64_t)0 : (((uint64_t)1 << (num_bits - lane * 64)) - 1));
+    return w;
+}
+
+/**
+ * @brief
+ * Number of set bits in a kmer word
+ */
+template <typename word_t>
+inline int kmer_word_popcount(const word_t &w)
+{
+    int count = 0;
+    for (int lane = 0; lane < kmer_word_lanes<word_t>; ++lane)
+        count += std::popcount(kmer_word_lane(w, lane));
+    return count;
+}
+
+/**
+ * @brief
+ * 64-bit finaliser from MurmurHash3, a bijection with good avalanche that maps 0 to 0
+ */
+inline uint64_t mix_hash64(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/**
+ * @brief
+ * 64-bit hash of a kmer word, seeded with hash_seed
+ * The upper lanes are folded in from the top down, and since mix_hash64(0) = 0 all-zero upper lanes do not change the hash,
+ * so the same value hashes identically whichever word type it is held in
+ * For a code of at most 64 bits this is a single mix_hash64
+ *
+ * @param w kmer word to be hashed
+ * @param hash_seed seed selecting the hash function
+ * @return 64-bit hash
+ */
+template <typename word_t>
+inline uint64_t kmer_word_hash(const word_t &w, const uint64_t hash_seed)
+{
+    uint64_t upper_hash = 0;
+    for (int lane = kmer_word_lanes<word_t> - 1; lane >= 1; --lane)
+        upper_hash = mix_hash64(kmer_word_lane(w, lane) ^ upper_hash);
+    return mix_hash64(kmer_word_lane(w, 0) ^ hash_seed ^ upper_hash);
+}
+
+/**
+ * @brief
+ * Reverses the order of the 2-bit nucleotides within a 64-bit lane
+ */
+inline uint64_t reverse_nucleotides_in_lane(uint64_t x)
+{
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return __builtin_bswap64(x);
+}
+
+/**
+ * @brief
+ * Reverses the order of the 2-bit nucleotides across a whole kmer word
+ */
+template <typename word_t>
+inline word_t reverse_nucleotides(const word_t &w)
+{
+    word_t r = 0;
+    for (int lane = 0; lane < kmer_word_lanes<word_t>; ++lane)
+        or_kmer_word_lane(r, kmer_word_lanes<word_t> - 1 - lane, reverse_nucleotides_in_lane(kmer_word_lane(w, lane)));
+    return r;
+}
+
+/**
+ * @brief
+ * ORs up to 64 bits into a kmer word starting at bit index offset, spilling into the next lane if needed
+ * Bits that fall outside the word are dropped
+ */
+template <typename word_t>
+inline void or_kmer_word_bits(word_t &w, const int offset, const uint64_t value)
+{
+    const int lane = offset / 64, bit_shift = offset % 64;
+    if (lane < kmer_word_lanes<word_t>)
+        or_kmer_word_lane(w, lane, value << bit_shift);
+    if (bit_shift != 0 && lane + 1 < kmer_word_lanes<word_t>)
+        or_kmer_word_lane(w, lane + 1, value >> (64 - bit_shift));
+}
+
+/**
+ * @brief
+ * Gathers the bits of x selected by mask into the lowest bits, one bit at a time
+ * Only used off the hot path, spaced_seed_compactor should be used in loops
+ */
+inline uint64_t gather_bits_in_lane(uint64_t x, uint64_t mask)
+{
+    uint64_t r = 0;
+    for (int out_bit = 0; mask != 0; mask &= mask - 1, ++out_bit)
+        r |= ((x >> std::countr_zero(mask)) & 0x1) << out_bit;
+    return r;
+}
+
+/**
+ * @brief
+ * Precomputed plan to compact a spaced kmer: gathers the bits selected by a mask into a dense word,
+ * keeping their order, so a kmer with k used positions becomes a 2k-bit code
+ * Compaction preserves order, so comparing compacted codes gives the same result as comparing masked windows
+ *
+ * Uses _pext_u64 on each 64-bit lane when BMI2 is available,
+ * and otherwise the compress operation from Hacker's Delight (section 7-4),
+ * whose six move masks depend only on the mask and are precomputed here
+ *
+ * @tparam word_t fixed-width word type holding the window
+ * @param lane_masks mask bits in each 64-bit lane
+ * @param lane_offsets bit index in the compacted code where each lane starts
+ * @param lane_move_masks bits moved right by 1, 2, 4, 8, 16 and 32 positions in each lane (fallback only)
+ */
+template <typename word_t>
+struct spaced_seed_compactor
+{
+    static constexpr int LANES = kmer_word_lanes<word_t>;
+
+    uint64_t lane_masks[LANES];
+    int lane_offsets[LANES];
+#if !defined(__BMI2__)
+    uint64_t lane_move_masks[LANES][6];
+#endif
+
+    explicit spaced_seed_compactor(const word_t &mask)
+    {
+        int offset = 0;
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            lane_masks[lane] = kmer_word_lane(mask, lane);
+            lane_offsets[lane] = offset;
+            offset += std::popcount(lane_masks[lane]);
+
+#if !defined(__BMI2__)
+            // Each step moves the bits that have an odd number of mask 0s to their right by the next power of two
+            uint64_t m = lane_masks[lane];
+            uint64_t zeros_to_right = ~m << 1;
+            for (int step = 0; step < 6; ++step)
+            {
+                uint64_t parity = zeros_to_right ^ (zeros_to_right << 1);
+                parity ^= parity << 2;
+                parity ^= parity << 4;
+                parity ^= parity << 8;
+                parity ^= parity << 16;
+                parity ^= parity << 32;
+                const uint64_t move_mask = parity & m;
+                lane_move_masks[lane][step] = move_mask;
+                m = (m ^ move_mask) | (move_mask >> (1 << step));
+                zeros_to_right &= ~parity;
+            }
+#endif
+        }
+    }
+
+    /**
+     * @brief
+     * Compacts the bits of a single lane of a window selected by the mask
+     */
+    inline uint64_t compact_lane(const uint64_t x, const int lane) const
+    {
+#if defined(__BMI2__)
+        return _pext_u64(x, lane_masks[lane]);
+#else
+        uint64_t r = x & lane_masks[lane];
+        for (int step = 0; step < 6; ++step)
+        {
+            const uint64_t moved = r & lane_move_masks[lane][step];
+            r = (r ^ moved) | (moved >> (1 << step));
+        }
+        return r;
+#endif
+    }
+
+    /**
+     * @brief
+     * Compacts the bits of a window selected by the mask into the lowest bits of a code
+     *
+     * @tparam code_t word type of the compacted code, must hold at least popcount(mask) bits
+     * @param w window to be compacted (bits outside the mask are ignored)
+     * @return compacted code
+     */
+    template <typename code_t>
+    inline code_t compact(const word_t &w) const
+    {
+        code_t code = 0;
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            if (lane_masks[lane] != 0)
+                or_kmer_word_bits(code, lane_offsets[lane], compact_lane(kmer_word_lane(w, lane), lane));
+        }
+        return code;
+    }
+};
+
+#endif
@@ -11,11 +11,32 @@
 
 constexpr int KMERS_DEBUG = DEBUG | 0;
 
+/**
+ * @brief
+ * Compacts the bits of a kmer selected by a mask into the lowest bits of a kmer_code
+ * This is the slow reference version of spaced_seed_compactor, for use off the hot path
+ *
+ * @param kmer_bits raw bits of the kmer
+ * @param mask mask used for the kmer
+ * @return compacted kmer_code
+ */
+kmer_code compact_kmer_code(const kmer_code &kmer_bits, const kmer_code &mask)
+{
+    kmer_code code = 0;
+    int offset = 0;
+    for (int lane = 0; lane < KMER_CODE_WORDS; ++lane)
+    {
+        or_kmer_word_bits(code, offset, gather_bits_in_lane(kmer_bits.words[lane], mask.words[lane]));
+        offset += std::popcount(mask.words[lane]);
+    }
+    return code;
+}
+
 // TO DO: Support spaced seeds
 // Currently only supports palindromic masks
 kmer reverse_complement(kmer k)
 {
-    kmer_bitset rc_bits = (reverse_kmer_bitset(k.kmer_bits).flip()) >> ((MAX_KMER_LENGTH - k.window_length) * NUCLEOTIDE_BIT_SIZE);
+    kmer_code rc_bits = (~reverse_nucleotides(k.kmer_bits)) >> ((MAX_KMER_LENGTH - k.window_length) * NUCLEOTIDE_BIT_SIZE);
     if (KMERS_DEBUG)
         std::cout << k.kmer_bits << " reverse complemented to " << rc_bits << std::endl;
     if (KMERS_DEBUG)
@@ -24,7 +45,7 @@ kmer reverse_complement(kmer k)
         k.window_length,
         rc_bits,
         k.mask,
-        rc_bits & k.mask};
+        compact_kmer_code(rc_bits, k.mask)};
 }
 
 // Computes the canonical kmer for a kmer k
@@ -0,0 +1,111 @@
+/**
+ * @file mapped_file.cpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This file contains the POSIX implementation of mapped_file
+ */
+#include "mapped_file.hpp"
+
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief
+ * Maps the whole of the given file into memory
+ * On failure, good() returns false and no mapping is held
+ *
+ * @param filename path to the file to be mapped
+ */
+mapped_file::mapped_file(const char filename[])
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0)
+    {
+        close(fd);
+        return;
+    }
+
+    // mmap does not accept zero-length mappings, so an empty file is simply an empty range
+    if (file_stat.st_size == 0)
+    {
+        close(fd);
+        is_good = true;
+        return;
+    }
+
+    void *ptr = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps its own reference to the file, so the descriptor is no longer needed
+    close(fd);
+    if (ptr == MAP_FAILED)
+        return;
+
+    // Input files are read front to back exactly once
+    madvise(ptr, file_stat.st_size, MADV_SEQUENTIAL);
+
+    mapping = ptr;
+    data = static_cast<const char *>(ptr);
+    size = file_stat.st_size;
+    is_good = true;
+}
+
+mapped_file::~mapped_file()
+{
+    release();
+}
+
+mapped_file::mapped_file(mapped_file &&other) noexcept
+    : data(std::exchange(other.data, nullptr)),
+      size(std::exchange(other.size, 0)),
+      is_good(std::exchange(other.is_good, false)),
+      mapping(std::exchange(other.mapping, nullptr))
+{
+}
+
+mapped_file &mapped_file::operator=(mapped_file &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+        is_good = std::exchange(other.is_good, false);
+        mapping = std::exchange(other.mapping, nullptr);
+    }
+    return *this;
+}
+
+/**
+ * @brief
+ * Asks the kernel to start reading the whole file into the page cache in the background,
+ * so that a later pass over the data does not stall on disk reads
+ */
+void mapped_file::prefetch() const
+{
+    if (mapping != nullptr)
+        madvise(mapping, size, MADV_WILLNEED);
+}
+
+/**
+ * @brief
+ * Unmaps the file if it is currently mapped
+ */
+void mapped_file::release()
+{
+    if (mapping != nullptr)
+        munmap(mapping, size);
+    mapping = nullptr;
+    data = nullptr;
+    size = 0;
+}
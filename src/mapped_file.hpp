@@ -0,0 +1,65 @@
+/**
+ * @file mapped_file.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Read-only memory mapping of a whole file, used to read input files in place without copying them
+ */
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+#include <cstddef>
+
+/**
+ * @brief
+ * RAII wrapper around a read-only, private mmap of an entire file
+ * The mapping is released when the object is destroyed
+ * Empty files are represented by a null data pointer with size 0
+ *
+ * @param data pointer to the first byte of the mapped file
+ * @param size number of bytes in the mapped file
+ */
+struct mapped_file
+{
+    const char *data = nullptr;
+    size_t size = 0;
+
+    explicit mapped_file(const char filename[]);
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+    mapped_file(mapped_file &&other) noexcept;
+    mapped_file &operator=(mapped_file &&other) noexcept;
+
+    /**
+     * @brief
+     * Returns whether the file was opened and mapped successfully, mirroring std::ifstream::good
+     */
+    inline bool good() const
+    {
+        return is_good;
+    }
+
+    void prefetch() const;
+
+    inline const char *begin() const
+    {
+        return data;
+    }
+
+    inline const char *end() const
+    {
+        return data + size;
+    }
+
+private:
+    bool is_good = false;
+    void *mapping = nullptr;
+
+    void release();
+};
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * @file multi_resolution_sketch.cpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This file contains the coarse-to-fine screening of pairs of sketches
+ */
+#include "multi_resolution_sketch.hpp"
+
+#include <cmath>
+
+/**
+ * @brief
+ * Builds the nested sketches of a hash_sketch
+ *
+ * @param hs FracMinHash sketch, built at a scale no coarser than any of the scales
+ * @param scales coarser scales of the nested sketches, coarsest (largest) first
+ */
+multi_resolution_sketch::multi_resolution_sketch(const hash_sketch &hs, const std::vector<uint64_t> &scales)
+    : sketch(&hs)
+{
+    for (size_t l = 0; l < scales.size(); ++l)
+    {
+        if (scales[l] == 0 || (l > 0 && scales[l] > scales[l - 1]))
+            throw std::runtime_error("Screening scales must be positive and ordered from coarsest to finest");
+        level_sizes.push_back(std::lower_bound(hs.hashes.begin(), hs.hashes.end(), frac_min_hash_threshold(scales[l])) - hs.hashes.begin());
+    }
+    level_sizes.push_back(hs.sketch_size());
+}
+
+/**
+ * @brief
+ * Intersection size of two sketches, screened coarse to fine
+ * At every level, the pair is rejected if its largest containment (intersection over the smaller sketch) is clearly
+ * below min_containment, by SCREENING_STANDARD_DEVIATIONS standard deviations of the intersection of a sketch of that size
+ * Hashes above the threshold of a level are above it in both sketches, so the intersection of a finer level is the one of
+ * the coarser level plus the intersection of the remaining hashes, and no hash is compared twice
+ *
+ * @param ms1 nested sketches of the first sketch
+ * @param ms2 nested sketches of the second sketch, at the same scales
+ * @param min_containment smallest largest containment of the pairs kept
+ * @return intersection size of the full resolution sketches, or SCREENED_OUT_INTERSECTION if the pair is rejected
+ */
+int screened_hash_sketch_intersection(
+    const multi_resolution_sketch &ms1,
+    const multi_resolution_sketch &ms2,
+    const double min_containment)
+{
+    if (ms1.num_levels() != ms2.num_levels())
+        throw std::runtime_error("Multi-resolution sketches have different screening scales");
+
+    const uint64_t *hashes_1 = ms1.sketch->hashes.data();
+    const uint64_t *hashes_2 = ms2.sketch->hashes.data();
+    int intersection = 0;
+    int size_1 = 0, size_2 = 0;
+    for (size_t l = 0; l < ms1.num_levels(); ++l)
+    {
+        const int level_size_1 = ms1.level_sizes[l];
+        const int level_size_2 = ms2.level_sizes[l];
+        intersection += sorted_hash_intersection(
+            hashes_1 + size_1,
+            level_size_1 - size_1,
+            hashes_2 + size_2,
+            level_size_2 - size_2);
+        size_1 = level_size_1;
+        size_2 = level_size_2;
+
+        // The full resolution level is never screened
+        const int smaller_size = std::min(size_1, size_2);
+        if (l + 1 == ms1.num_levels() || smaller_size < MIN_SCREENING_SKETCH_SIZE)
+            continue;
+        const double expected_intersection = min_containment * smaller_size;
+        const double standard_deviation = std::sqrt(expected_intersection * (1 - min_containment));
+        if (intersection < expected_intersection - SCREENING_STANDARD_DEVIATIONS * standard_deviation)
+            return SCREENED_OUT_INTERSECTION;
+    }
+    return intersection;
+}
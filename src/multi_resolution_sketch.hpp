@@ -0,0 +1,76 @@
+/**
+ * @file multi_resolution_sketch.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the multi-resolution view of a FracMinHash hash_sketch, used to screen pairs of sketches
+ * at coarse scales before comparing them at full resolution
+ *
+ * A FracMinHash sketch at scale s keeps the hashes below UINT64_MAX / s, so the sketch at a coarser scale is exactly
+ * the set of hashes of the finer sketch below a smaller threshold, which is a prefix of its sorted hash array
+ * The nested sketches therefore cost no memory: a level is only the length of its prefix
+ */
+#ifndef MULTI_RESOLUTION_SKETCH_HPP
+#define MULTI_RESOLUTION_SKETCH_HPP
+#include "kmer.hpp"
+#include "hash_sketch.hpp"
+
+/**
+ * @brief
+ * Default screening scales, coarsest first, for sketches built at a scale of 200
+ */
+const std::vector<uint64_t> DEFAULT_SCREENING_SCALES = {10000, 1000};
+
+/**
+ * @brief
+ * Levels whose smaller sketch has fewer hashes than this are skipped, since their containment is too noisy to screen with
+ */
+constexpr int MIN_SCREENING_SKETCH_SIZE = 64;
+
+/**
+ * @brief
+ * A pair is only rejected at a coarse level when its intersection is this many binomial standard deviations below the
+ * expected intersection at min_containment, so that the sampling noise of the small sketches rarely rejects a kept pair
+ */
+constexpr double SCREENING_STANDARD_DEVIATIONS = 3.0;
+
+/**
+ * @brief
+ * Intersection returned for the pairs rejected by the screening
+ */
+constexpr int SCREENED_OUT_INTERSECTION = -1;
+
+/**
+ * @brief
+ * Nested sketches of a FracMinHash hash_sketch at several scales
+ * Level l holds the first level_sizes[l] hashes of the sketch, the last level being the whole sketch
+ *
+ * @param sketch full resolution sketch, which must outlive the view
+ * @param level_sizes number of hashes of every level, coarsest first
+ */
+struct multi_resolution_sketch
+{
+    const hash_sketch *sketch;
+    std::vector<int> level_sizes;
+
+    multi_resolution_sketch(const hash_sketch &hs, const std::vector<uint64_t> &scales);
+
+    /**
+     * @brief
+     * Helper function for the number of levels, including the full resolution one
+     */
+    inline size_t num_levels() const
+    {
+        return level_sizes.size();
+    }
+};
+
+int screened_hash_sketch_intersection(
+    const multi_resolution_sketch &ms1,
+    const multi_resolution_sketch &ms2,
+    const double min_containment);
+
+#endif
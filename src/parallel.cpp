@@ -0,0 +1,260 @@
+/**
+ * @file parallel.cpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This file contains the work-stealing thread pool used when not compiling with OpenCilk
+ */
+#include "parallel.hpp"
+
+#include <cstdlib>
+#include <string>
+
+/**
+ * @brief
+ * Index of the worker running on this thread in the pool it belongs to, or -1 on other threads
+ */
+thread_local int current_worker_idx = -1;
+thread_local const work_stealing_pool *current_pool = nullptr;
+
+/**
+ * @brief
+ * Runs the callable of the task, then marks it as done and wakes up any thread blocked on it
+ * The waiter may destroy the task as soon as it sees done, so the task is not touched after done is published:
+ * a blocked waiter is woken through its own task_waiter, under a mutex it must take before returning
+ */
+void pool_task::execute()
+{
+    try
+    {
+        run(context);
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+    }
+
+    task_waiter *const blocked_waiter = waiter;
+    if (blocked_waiter == nullptr)
+    {
+        done.store(true, std::memory_order_release);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(blocked_waiter->mutex);
+    done.store(true, std::memory_order_release);
+    blocked_waiter->finished = true;
+    blocked_waiter->done_condition.notify_all();
+}
+
+/**
+ * @brief
+ * Starts the workers of the pool
+ *
+ * @param num_workers number of worker threads, at least 1
+ */
+work_stealing_pool::work_stealing_pool(const int num_workers)
+{
+    const int pool_size = std::max(1, num_workers);
+    for (int i = 0; i < pool_size; ++i)
+        worker_queues.push_back(std::make_unique<task_queue>());
+    for (int i = 0; i < pool_size; ++i)
+        workers.emplace_back(&work_stealing_pool::worker_loop, this, i);
+}
+
+/**
+ * @brief
+ * Stops the workers once the queued tasks are done
+ */
+work_stealing_pool::~work_stealing_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    work_available.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+/**
+ * @brief
+ * Pool shared by every parallel loop
+ * Has one worker per hardware thread, or PARALLEL_NUM_WORKERS workers if that environment variable is set
+ * (the counterpart of CILK_NWORKERS)
+ * The pool is never destroyed, so that exit() does not wait on the workers
+ *
+ * @return work_stealing_pool&
+ */
+work_stealing_pool &work_stealing_pool::instance()
+{
+    static work_stealing_pool *pool = []
+    {
+        int num_workers = std::thread::hardware_concurrency();
+        if (const char *num_workers_env = std::getenv("PARALLEL_NUM_WORKERS"))
+            num_workers = std::atoi(num_workers_env);
+        return new work_stealing_pool(num_workers);
+    }();
+    return *pool;
+}
+
+bool work_stealing_pool::is_worker_thread() const
+{
+    return current_pool == this;
+}
+
+/**
+ * @brief
+ * Runs a task on the workers from a thread that is not a worker, blocking until it is done
+ *
+ * @param task task to be run
+ */
+void work_stealing_pool::run(pool_task &task)
+{
+    task_waiter waiter;
+    task.waiter = &waiter;
+    push_task(submitted_tasks, task);
+
+    std::unique_lock<std::mutex> lock(waiter.mutex);
+    waiter.done_condition.wait(
+        lock,
+        [&]
+        { return waiter.finished; });
+}
+
+/**
+ * @brief
+ * Makes a task available to the other workers, must be called from a worker and followed by join
+ *
+ * @param task task to be run
+ */
+void work_stealing_pool::spawn(pool_task &task)
+{
+    push_task(*worker_queues[current_worker_idx], task);
+}
+
+/**
+ * @brief
+ * Waits for a spawned task to be done
+ * If no worker has stolen it, it is still at the back of this worker's deque and runs here,
+ * otherwise this worker runs other tasks until the thief is done with it
+ *
+ * @param task task passed to spawn by this worker
+ */
+void work_stealing_pool::join(pool_task &task)
+{
+    task_queue &own_queue = *worker_queues[current_worker_idx];
+    bool is_own_task = false;
+    {
+        std::lock_guard<std::mutex> lock(own_queue.mutex);
+        if (!own_queue.tasks.empty() && own_queue.tasks.back() == &task)
+        {
+            own_queue.tasks.pop_back();
+            is_own_task = true;
+        }
+    }
+    if (is_own_task)
+    {
+        --num_queued;
+        task.execute();
+        return;
+    }
+
+    while (!task.done.load(std::memory_order_acquire))
+    {
+        if (pool_task *other_task = find_task(current_worker_idx))
+            other_task->execute();
+        else
+            std::this_thread::yield();
+    }
+}
+
+/**
+ * @brief
+ * Adds a task to a queue, waking up a sleeping worker if there is one
+ */
+void work_stealing_pool::push_task(task_queue &queue, pool_task &task)
+{
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(&task);
+    }
+
+    // A worker going to sleep checks num_queued after incrementing num_sleeping, so one of the two sides sees the other
+    ++num_queued;
+    if (num_sleeping > 0)
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        work_available.notify_one();
+    }
+}
+
+/**
+ * @brief
+ * Takes the next task for a worker: the newest task of its own deque, then the oldest submitted task,
+ * then the oldest task of another worker, starting from its neighbour
+ *
+ * @param worker_idx index of the worker
+ * @return task to be run, or nullptr if every queue is empty
+ */
+pool_task *work_stealing_pool::find_task(const int worker_idx)
+{
+    auto take_task = [&](task_queue &queue, const bool from_back) -> pool_task *
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return nullptr;
+        pool_task *task;
+        if (from_back)
+        {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+        }
+        --num_queued;
+        return task;
+    };
+
+    if (pool_task *task = take_task(*worker_queues[worker_idx], true))
+        return task;
+    if (pool_task *task = take_task(submitted_tasks, false))
+        return task;
+    for (size_t i = 1; i < worker_queues.size(); ++i)
+    {
+        if (pool_task *task = take_task(*worker_queues[(worker_idx + i) % worker_queues.size()], false))
+            return task;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief
+ * Runs tasks until the pool is stopped, sleeping while there are none
+ */
+void work_stealing_pool::worker_loop(const int worker_idx)
+{
+    current_worker_idx = worker_idx;
+    current_pool = this;
+    while (true)
+    {
+        if (pool_task *task = find_task(worker_idx))
+        {
+            task->execute();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        ++num_sleeping;
+        work_available.wait(lock, [&]
+                            { return stopping || num_queued > 0; });
+        --num_sleeping;
+        if (stopping && num_queued <= 0)
+            return;
+    }
+}
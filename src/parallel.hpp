@@ -0,0 +1,258 @@
+/**
+ * @file parallel.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the fork-join primitives used for all parallel loops, with two backends chosen at build time:
+ *  OpenCilk : used when compiling with -fopencilk, parallel_for is a cilk_for and parallel_invoke a cilk_spawn
+ *  threads  : used otherwise (or when PARALLEL_THREAD_POOL is defined), a small work-stealing pool on std::thread,
+ *             so a stock GCC/Clang build is still parallel
+ *
+ * Both backends run nested parallel loops (files x chunks, pairs x intersections) on one fixed set of workers,
+ * so nesting never creates more threads than cores
+ */
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__cilk) && !defined(PARALLEL_THREAD_POOL)
+#define PARALLEL_CILK_BACKEND 1
+#include <cilk/cilk.h>
+#include <cilk/cilk_api.h>
+#else
+#define PARALLEL_CILK_BACKEND 0
+#endif
+
+/**
+ * @brief
+ * Largest number of iterations run serially by one task of parallel_for, the same bound cilk_for uses
+ */
+constexpr size_t PARALLEL_FOR_MAX_GRAIN = 2048;
+
+/**
+ * @brief
+ * Signal a thread blocks on until a task is done, owned by the waiting thread
+ * The waiter returns only after taking the mutex, which the worker releases as its very last access,
+ * so the waiter may destroy the task and the signal as soon as it wakes up
+ *
+ * @param mutex mutex guarding finished
+ * @param done_condition notified once the task is done
+ * @param finished set once the task is done
+ */
+struct task_waiter
+{
+    std::mutex mutex;
+    std::condition_variable done_condition;
+    bool finished = false;
+};
+
+/**
+ * @brief
+ * Unit of work of the thread pool, referring to a callable owned by the code that spawned it
+ * The spawner waits for done before leaving the scope of the callable, so tasks never own any memory
+ * Once done is set, the task may already be destroyed, so nothing touches it afterwards
+ *
+ * @param run function calling the callable
+ * @param context pointer to the callable
+ * @param done set once the callable has returned or thrown
+ * @param exception exception thrown by the callable, if any
+ * @param waiter signal of a thread blocked on the task, or nullptr if the waiter spins on done
+ */
+struct pool_task
+{
+    void (*run)(void *);
+    void *context;
+    std::atomic<bool> done = false;
+    std::exception_ptr exception;
+    task_waiter *waiter = nullptr;
+
+    template <typename callable_t>
+    explicit pool_task(callable_t &f)
+        : run([](void *c)
+              { (*static_cast<callable_t *>(c))(); }),
+          context(const_cast<void *>(static_cast<const void *>(&f))) {}
+
+    void execute();
+};
+
+/**
+ * @brief
+ * Work-stealing thread pool
+ * Every worker owns a deque of tasks: it pushes and pops its own tasks at the back, in depth-first order,
+ * and idle workers steal from the front of the other deques, where the largest pieces of work are
+ * Threads that are not workers submit their tasks through a shared queue and block until they are done
+ *
+ * @param worker_queues task deque of every worker
+ * @param submitted_tasks tasks submitted by threads that are not workers
+ * @param num_queued number of tasks waiting in all the queues
+ * @param num_sleeping number of workers waiting for tasks on work_available
+ */
+struct work_stealing_pool
+{
+    explicit work_stealing_pool(const int num_workers);
+    work_stealing_pool(const work_stealing_pool &) = delete;
+    work_stealing_pool &operator=(const work_stealing_pool &) = delete;
+    ~work_stealing_pool();
+
+    static work_stealing_pool &instance();
+
+    inline int num_workers() const
+    {
+        return workers.size();
+    }
+
+    bool is_worker_thread() const;
+    void run(pool_task &task);
+    void spawn(pool_task &task);
+    void join(pool_task &task);
+
+private:
+    struct task_queue
+    {
+        std::mutex mutex;
+        std::deque<pool_task *> tasks;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<task_queue>> worker_queues;
+    task_queue submitted_tasks;
+    std::atomic<long> num_queued = 0;
+    std::atomic<int> num_sleeping = 0;
+    std::atomic<bool> stopping = false;
+    std::mutex sleep_mutex;
+    std::condition_variable work_available;
+
+    void push_task(task_queue &queue, pool_task &task);
+    pool_task *find_task(const int worker_idx);
+    void worker_loop(const int worker_idx);
+};
+
+/**
+ * @brief
+ * Number of workers running parallel loops
+ *
+ * @return int
+ */
+inline int parallel_num_workers()
+{
+#if PARALLEL_CILK_BACKEND
+    return __cilkrts_get_nworkers();
+#else
+    return work_stealing_pool::instance().num_workers();
+#endif
+}
+
+/**
+ * @brief
+ * Runs f and g in parallel, returning once both have returned
+ * If either throws, the exception is rethrown here after both have finished
+ *
+ * @param f first callable taking no arguments
+ * @param g second callable taking no arguments
+ */
+template <typename callable_1, typename callable_2>
+void parallel_invoke(callable_1 &&f, callable_2 &&g)
+{
+#if PARALLEL_CILK_BACKEND
+    cilk_spawn f();
+    g();
+    cilk_sync;
+#else
+    work_stealing_pool &pool = work_stealing_pool::instance();
+    if (!pool.is_worker_thread())
+    {
+        // Hand the whole fork-join tree to the workers, so the calling thread does not add to their number
+        auto root = [&]
+        { parallel_invoke(f, g); };
+        pool_task root_task(root);
+        pool.run(root_task);
+        if (root_task.exception)
+            std::rethrow_exception(root_task.exception);
+        return;
+    }
+
+    pool_task spawned_task(g);
+    pool.spawn(spawned_task);
+    std::exception_ptr exception;
+    try
+    {
+        f();
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+    }
+
+    // g refers to this frame, so it must be finished before anything is rethrown
+    pool.join(spawned_task);
+    if (exception)
+        std::rethrow_exception(exception);
+    if (spawned_task.exception)
+        std::rethrow_exception(spawned_task.exception);
+#endif
+}
+
+/**
+ * @brief
+ * Splits [begin, end) in halves until the ranges hold at most grain iterations
+ */
+template <typename index_t, typename body_t>
+void parallel_for_range(const index_t begin, const index_t end, const index_t grain, body_t &body)
+{
+    if (end - begin <= grain)
+    {
+        for (index_t i = begin; i < end; ++i)
+            body(i);
+        return;
+    }
+    const index_t middle = begin + (end - begin) / 2;
+    parallel_invoke(
+        [&]
+        { parallel_for_range(begin, middle, grain, body); },
+        [&]
+        { parallel_for_range(middle, end, grain, body); });
+}
+
+/**
+ * @brief
+ * Calls body(i) for every i in [begin, end), in parallel
+ * Can be nested freely, the inner loops are run by the same workers as the outer ones
+ *
+ * @param begin first index
+ * @param end one past the last index
+ * @param body callable taking an index_t
+ */
+template <typename index_t, typename body_t>
+void parallel_for(const index_t begin, const index_t end, body_t &&body)
+{
+#if PARALLEL_CILK_BACKEND
+    cilk_for(index_t i = begin; i < end; ++i)
+    {
+        body(i);
+    }
+#else
+    if (begin >= end)
+        return;
+
+    // Same grain as cilk_for: about 8 tasks per worker, so that stealing can balance uneven iterations
+    const size_t num_iterations = end - begin;
+    const size_t grain = std::clamp<size_t>(
+        num_iterations / (8 * parallel_num_workers()),
+        1,
+        PARALLEL_FOR_MAX_GRAIN);
+    parallel_for_range(begin, end, (index_t)grain, body);
+#endif
+}
+
+#endif
@@ -0,0 +1,397 @@
+/**
+ * @file sketch_cache.cpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This file contains the implementation of the sketch cache
+ */
+#include "sketch_cache.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief
+ * Seeds of the two 64-bit halves of the content digest
+ */
+constexpr uint64_t CONTENT_DIGEST_SEED_1 = 0x243F6A8885A308D3ULL;
+constexpr uint64_t CONTENT_DIGEST_SEED_2 = 0x13198A2E03707344ULL;
+
+/**
+ * @brief
+ * Formats a 64-bit value as 16 hexadecimal digits
+ */
+inline std::string hex_string(const uint64_t value)
+{
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)value);
+    return std::string(buffer);
+}
+
+/**
+ * @brief
+ * 128-bit digest of a byte range, as 32 hexadecimal digits
+ * Two differently seeded chains of mix_hash64 run over the 8-byte words, which is not cryptographic
+ * but is enough to tell apart the files of a corpus
+ *
+ * @param data pointer to the first byte
+ * @param size number of bytes
+ * @return digest of the bytes
+ */
+inline std::string content_digest(const char *data, const size_t size)
+{
+    uint64_t digest_1 = CONTENT_DIGEST_SEED_1;
+    uint64_t digest_2 = CONTENT_DIGEST_SEED_2;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        digest_1 = mix_hash64(digest_1 ^ word);
+        digest_2 = mix_hash64(digest_2 + word) ^ word;
+    }
+    uint64_t last_word = 0;
+    if (i < size)
+        std::memcpy(&last_word, data + i, size - i);
+    digest_1 = mix_hash64(digest_1 ^ last_word ^ size);
+    digest_2 = mix_hash64(digest_2 + last_word + size);
+    return hex_string(digest_1) + hex_string(digest_2);
+}
+
+/**
+ * @brief
+ * Hash of the sketch parameters and of the sketch file version, as 16 hexadecimal digits
+ */
+inline std::string parameters_digest(const sketch_parameters &parameters)
+{
+    std::vector<uint64_t> mask_words;
+    boost::to_block_range(parameters.mask, std::back_inserter(mask_words));
+
+    uint64_t digest = mix_hash64(SKETCH_FILE_VERSION ^ CONTENT_DIGEST_SEED_1);
+    digest = mix_hash64(digest ^ (uint64_t)parameters.window_length);
+    digest = mix_hash64(digest ^ parameters.mask.size());
+    for (const uint64_t mask_word : mask_words)
+        digest = mix_hash64(digest ^ mask_word);
+    digest = mix_hash64(digest ^ parameters.hash_seed);
+    digest = mix_hash64(digest ^ parameters.scale);
+    return hex_string(digest);
+}
+
+/**
+ * @brief
+ * Opens a cache directory, creating it if needed, and loads its digest index
+ *
+ * @param directory path to the cache directory
+ * @param max_size maximum total size of the entries, in bytes
+ */
+sketch_cache::sketch_cache(const std::string &directory, const uint64_t max_size)
+    : directory(directory), max_size(max_size)
+{
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (!fs::is_directory(directory))
+        throw std::runtime_error("Unable to create sketch cache directory " + directory);
+
+    for (const fs::directory_entry &entry : fs::directory_iterator(directory))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ENTRY_EXTENSION)
+            total_size += entry.file_size();
+    }
+
+    // Later lines of the index replace earlier ones for the same file
+    {
+        std::ifstream digest_index((fs::path(directory) / DIGEST_INDEX_FILENAME).string());
+        digest_record record;
+        std::string path;
+        while (digest_index >> record.file_size >> record.modification_time >> record.digest && std::getline(digest_index >> std::ws, path))
+        {
+            digests[path] = record;
+            ++num_index_records;
+        }
+    }
+    compact_digest_index();
+
+    if (LOGGING)
+        std::clog << INFO_LOG << "Opened sketch cache " << directory << " holding " << total_size << " bytes" << std::endl;
+}
+
+/**
+ * @brief
+ * Digest of the contents of a file
+ * The file is only read when its size or modification time differ from the ones recorded in the digest index
+ *
+ * @param fasta_filename path to the file
+ * @return digest of the contents of the file
+ */
+std::string sketch_cache::file_digest(const std::string &fasta_filename)
+{
+    const std::string path = fs::absolute(fasta_filename).lexically_normal().string();
+    std::error_code error;
+    const uintmax_t file_size = fs::file_size(path, error);
+    const int64_t modification_time = error ? 0 : fs::last_write_time(path, error).time_since_epoch().count();
+
+    auto record = digests.find(path);
+    if (!error && record != digests.end() &&
+        record->second.file_size == file_size &&
+        record->second.modification_time == modification_time)
+        return record->second.digest;
+
+    mapped_file fasta_file(fasta_filename.c_str());
+
+    if (!fasta_file.good())
+        throw std::runtime_error("Unable to open " + fasta_filename);
+    const std::string digest = content_digest(fasta_file.data, fasta_file.size);
+
+    digests[path] = {file_size, modification_time, digest};
+    std::ofstream digest_index((fs::path(directory) / DIGEST_INDEX_FILENAME).string(), std::ios_base::app);
+    digest_index << file_size << '\t' << modification_time << '\t' << digest << '\t' << path << '\n';
+    ++num_index_records;
+    return digest;
+}
+
+/**
+ * @brief
+ * Path of the entry holding the sketch of a file with the given parameters
+ *
+ * @param fasta_filename path to the file
+ * @param parameters parameters of the sketch
+ * @return path to the entry, which may not exist
+ */
+std::string sketch_cache::entry_path(const std::string &fasta_filename, const sketch_parameters &parameters)
+{
+    return (fs::path(directory) / (file_digest(fasta_filename) + "-" + parameters_digest(parameters) + ENTRY_EXTENSION)).string();
+}
+
+/**
+ * @brief
+ * Looks up the sketch of a file, marking the entry as recently used
+ *
+ * @param fasta_filename path to the file
+ * @param parameters parameters of the sketch
+ * @return the mapped sketch, or std::nullopt if there is no valid entry for it
+ */
+std::optional<mapped_sketch> sketch_cache::lookup(const std::string &fasta_filename, const sketch_parameters &parameters)
+{
+    const std::string path = entry_path(fasta_filename, parameters);
+    mapped_sketch cached(path.c_str());
+    if (!cached.good() || !(cached.parameters == parameters))
+        return std::nullopt;
+
+    std::error_code error;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+    return cached;
+}
+
+/**
+ * @brief
+ * Adds the sketch of a file, then removes the least recently used entries if the cache is over its size
+ *
+ * @param fasta_filename path to the file
+ * @param parameters parameters the sketch was built with
+ * @param hs sketch of the file
+ */
+void sketch_cache::store(const std::string &fasta_filename, const sketch_parameters &parameters, const hash_sketch &hs)
+{
+    const std::string path = entry_path(fasta_filename, parameters);
+    std::error_code error;
+    const uintmax_t old_size = fs::exists(path, error) ? fs::file_size(path, error) : 0;
+    if (!write_sketch_file(path.c_str(), parameters, hs))
+        throw std::runtime_error("Unable to write to sketch cache " + directory);
+    total_size += fs::file_size(path) - old_size;
+
+    if (total_size > max_size)
+        evict(path);
+}
+
+/**
+ * @brief
+ * Removes every entry of the current contents of a file, whatever its parameters
+ *
+ * @param fasta_filename path to the file
+ */
+void sketch_cache::invalidate(const std::string &fasta_filename)
+{
+    const std::string prefix = file_digest(fasta_filename) + "-";
+    std::vector<fs::path> entries;
+    for (const fs::directory_entry &entry : fs::directory_iterator(directory))
+    {
+        if (entry.path().filename().string().starts_with(prefix) && entry.path().extension() == ENTRY_EXTENSION)
+            entries.push_back(entry.path());
+    }
+    for (const fs::path &entry : entries)
+    {
+        std::error_code error;
+        const uintmax_t entry_size = fs::file_size(entry, error);
+        if (fs::remove(entry, error))
+            total_size -= entry_size;
+    }
+    compact_digest_index();
+}
+
+/**
+ * @brief
+ * Removes every entry and the digest index
+ */
+void sketch_cache::clear()
+{
+    std::vector<fs::path> entries;
+    for (const fs::directory_entry &entry : fs::directory_iterator(directory))
+    {
+        if (entry.path().extension() == ENTRY_EXTENSION || entry.path().filename() == DIGEST_INDEX_FILENAME)
+            entries.push_back(entry.path());
+    }
+    for (const fs::path &entry : entries)
+    {
+        std::error_code error;
+        fs::remove(entry, error);
+    }
+    digests.clear();
+    num_index_records = 0;
+    total_size = 0;
+}
+
+/**
+ * @brief
+ * Removes the least recently used entries until the cache fits in max_size
+ *
+ * @param kept_entry_path entry that is never removed, the one just stored
+ */
+void sketch_cache::evict(const std::string &kept_entry_path)
+{
+    struct cache_entry
+    {
+        fs::file_time_type last_use;
+        uintmax_t size;
+        fs::path path;
+    };
+    std::vector<cache_entry> entries;
+    total_size = 0;
+    for (const fs::directory_entry &entry : fs::directory_iterator(directory))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ENTRY_EXTENSION)
+            continue;
+        entries.push_back({entry.last_write_time(), entry.file_size(), entry.path()});
+        total_size += entry.file_size();
+    }
+    std::sort(
+        entries.begin(),
+        entries.end(),
+        [](const cache_entry &a, const cache_entry &b)
+        { return a.last_use < b.last_use; });
+
+    for (const cache_entry &entry : entries)
+    {
+        if (total_size <= max_size)
+            break;
+        std::error_code error;
+        if (entry.path != fs::path(kept_entry_path) && fs::remove(entry.path, error))
+            total_size -= entry.size;
+    }
+    compact_digest_index();
+
+    if (LOGGING)
+        std::clog << INFO_LOG << "Sketch cache " << directory << " trimmed to " << total_size << " bytes" << std::endl;
+}
+
+/**
+ * @brief
+ * Removes the records of the digest index whose contents have no entry left in the cache, after invalidation or eviction,
+ * and the records replaced by later ones for the same file
+ * The index is only appended to while the cache is used, so it is rewritten here, under a temporary name then renamed,
+ * and only when it holds such records
+ */
+void sketch_cache::compact_digest_index()
+{
+    std::unordered_set<std::string> entry_digests;
+    for (const fs::directory_entry &entry : fs::directory_iterator(directory))
+    {
+        const std::string entry_name = entry.path().filename().string();
+        if (entry.path().extension() == ENTRY_EXTENSION)
+            entry_digests.insert(entry_name.substr(0, entry_name.find('-')));
+    }
+    const size_t num_stale_records = std::erase_if(
+        digests,
+        [&](const auto &path_record)
+        { return !entry_digests.contains(path_record.second.digest); });
+    if (num_stale_records == 0 && num_index_records == digests.size())
+        return;
+
+    const fs::path index_path = fs::path(directory) / DIGEST_INDEX_FILENAME;
+    const fs::path temporary_path = fs::path(index_path.string() + ".tmp");
+    {
+        std::ofstream digest_index(temporary_path.string(), std::ios_base::trunc);
+        for (const auto &[path, record] : digests)
+            digest_index << record.file_size << '\t' << record.modification_time << '\t' << record.digest << '\t' << path << '\n';
+        if (!digest_index)
+            throw std::runtime_error("Unable to write the digest index of sketch cache " + directory);
+    }
+    fs::rename(temporary_path, index_path);
+    num_index_records = digests.size();
+
+    if (LOGGING)
+        std::clog << INFO_LOG << "Digest index of sketch cache " << directory << " compacted to " << num_index_records << " records" << std::endl;
+}
+
+/**
+ * @brief
+ * Version of parallel_hash_sketches_from_fasta_files reusing the sketches of a sketch cache
+ * Only the files missing from the cache are read and sketched (through the pipeline), and are then added to it
+ *
+ * @param cache sketch cache
+ * @param fasta_filenames list of file names to be read
+ * @param parameters parameters of the sketches, giving the mask and window length used
+ * @param policy FracMinHash policy deciding which kmers are used, which must be the one described by parameters
+ * @param fmh hash function whose hashes are stored in the sketches
+ * @return a list of hash_sketches corresponding to the file names given
+ */
+std::vector<hash_sketch> cached_hash_sketches_from_fasta_files(
+    sketch_cache &cache,
+    const std::vector<std::string> &fasta_filenames,
+    const sketch_parameters &parameters,
+    const frac_min_hash_policy &policy,
+    const frac_min_hash &fmh)
+{
+    if (fmh.hash_seed != parameters.hash_seed)
+        throw std::runtime_error("Hash function does not match the hash seed of the sketch parameters");
+    check_cached_policy(policy, parameters);
+
+    std::vector<hash_sketch> hash_sketches(fasta_filenames.size());
+    std::vector<size_t> missing_indices;
+    std::vector<std::string> missing_filenames;
+    for (size_t i = 0; i < fasta_filenames.size(); ++i)
+    {
+        if (std::optional<mapped_sketch> cached = cache.lookup(fasta_filenames[i], parameters))
+        {
+            hash_sketches[i] = cached->to_hash_sketch();
+        }
+        else
+        {
+            missing_indices.push_back(i);
+            missing_filenames.push_back(fasta_filenames[i]);
+        }
+    }
+
+    if (LOGGING)
+        std::clog << INFO_LOG << "Sketch cache hits: " << fasta_filenames.size() - missing_filenames.size() << "/" << fasta_filenames.size() << std::endl;
+    if (missing_filenames.empty())
+        return hash_sketches;
+
+    std::vector<hash_sketch> missing_sketches = pipelined_hash_sketches_from_fasta_files(
+        missing_filenames,
+        parameters.mask,
+        parameters.window_length,
+        policy,
+        fmh);
+    for (size_t j = 0; j < missing_indices.size(); ++j)
+    {
+        cache.store(missing_filenames[j], parameters, missing_sketches[j]);
+        hash_sketches[missing_indices[j]] = std::move(missing_sketches[j]);
+    }
+    return hash_sketches;
+}
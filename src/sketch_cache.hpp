@@ -0,0 +1,100 @@
+/**
+ * @file sketch_cache.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the sketch cache, a directory of sketch files (see sketch_file.hpp) reused across runs
+ *
+ * Entries are content-addressed: an entry is named after the digest of the contents of the .fasta file
+ * and a hash of the sketch parameters (window length, mask, hash seed, scale), so renamed or copied files share entries
+ * and an edited file never hits an old entry
+ * The digest of every file is remembered together with its size and modification time in DIGEST_INDEX_FILENAME,
+ * so unchanged files are not read again to be hashed
+ * Once the entries take more than max_size bytes, the least recently used ones are removed
+ */
+#ifndef SKETCH_CACHE_HPP
+#define SKETCH_CACHE_HPP
+#include <optional>
+#include "sketch_file.hpp"
+#include "sketch_pipeline.hpp"
+
+/**
+ * @brief
+ * Default maximum total size of the entries of a sketch cache, in bytes
+ */
+constexpr uint64_t DEFAULT_SKETCH_CACHE_MAX_SIZE = (4ULL << 30);
+
+/**
+ * @brief
+ * Directory of cached sketch files
+ *
+ * @param directory path to the cache directory, created if missing
+ * @param max_size maximum total size of the entries, in bytes
+ * @param total_size current total size of the entries, in bytes
+ */
+struct sketch_cache
+{
+    static constexpr const char *DIGEST_INDEX_FILENAME = "digests.tsv";
+    static constexpr const char *ENTRY_EXTENSION = SKETCH_FILE_EXTENSION;
+
+    std::string directory;
+    uint64_t max_size;
+    uint64_t total_size = 0;
+
+    explicit sketch_cache(const std::string &directory, const uint64_t max_size = DEFAULT_SKETCH_CACHE_MAX_SIZE);
+
+    std::string file_digest(const std::string &fasta_filename);
+    std::string entry_path(const std::string &fasta_filename, const sketch_parameters &parameters);
+    std::optional<mapped_sketch> lookup(const std::string &fasta_filename, const sketch_parameters &parameters);
+    void store(const std::string &fasta_filename, const sketch_parameters &parameters, const hash_sketch &hs);
+    void invalidate(const std::string &fasta_filename);
+    void clear();
+
+private:
+    /**
+     * @brief
+     * Digest of a file, valid as long as the file keeps the same size and modification time
+     */
+    struct digest_record
+    {
+        uintmax_t file_size;
+        int64_t modification_time;
+        std::string digest;
+    };
+
+    std::unordered_map<std::string, digest_record> digests;
+    size_t num_index_records = 0;
+
+    void evict(const std::string &kept_entry_path);
+    void compact_digest_index();
+};
+
+/**
+ * @brief
+ * Checks that a policy is the one described by sketch parameters, before sketches built with it go through the cache
+ * The cache entries are keyed on the window length, mask, hash seed and scale only, which describe FracMinHash sketches,
+ * so sketches built with any other policy (bottom-k, ModHash, ...) would share keys and cannot be cached
+ *
+ * @param policy FracMinHash policy used to build the sketches
+ * @param parameters parameters the sketches are cached under
+ */
+inline void check_cached_policy(const frac_min_hash_policy &policy, const sketch_parameters &parameters)
+{
+    if (parameters.scale == 0 ||
+        policy.fmh.hash_seed != parameters.hash_seed ||
+        policy.hash_threshold != frac_min_hash_threshold(parameters.scale))
+        throw std::runtime_error("Sketching policy does not match the hash seed and scale of the cached sketch parameters");
+}
+
+// Helper function for sketching files through the cache
+std::vector<hash_sketch> cached_hash_sketches_from_fasta_files(
+    sketch_cache &cache,
+    const std::vector<std::string> &fasta_filenames,
+    const sketch_parameters &parameters,
+    const frac_min_hash_policy &policy,
+    const frac_min_hash &fmh);
+
+#endif
@@ -0,0 +1,199 @@
+/**
+ * @file sketch_file.cpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This file contains the reading, writing and comparison of binary sketch files
+ */
+#include "sketch_file.hpp"
+
+#include <cstdio>
+
+static_assert(sizeof(kmer_bitset::block_type) == sizeof(uint64_t), "Mask blocks are stored as 64-bit words");
+
+/**
+ * @brief
+ * Checks whether a file starts like a sketch file, so that sketch files and .fasta files can be given in the same list
+ * The rest of the file is only checked once it is mapped (see mapped_sketch::good)
+ *
+ * @param filename path to the file
+ * @return true if the file exists and starts with SKETCH_FILE_MAGIC
+ */
+bool is_sketch_file(const char filename[])
+{
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(SKETCH_FILE_MAGIC)];
+    if (!file.read(magic, sizeof(magic)))
+        return false;
+    return std::memcmp(magic, SKETCH_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+/**
+ * @brief
+ * Writes a hash_sketch and its parameters to a sketch file
+ * The file is written under a temporary name and renamed at the end, so readers never see a partial file
+ *
+ * @param filename path to the sketch file
+ * @param parameters parameters the sketch was built with
+ * @param hs hash sketch to be written
+ * @return true if the file was written
+ */
+bool write_sketch_file(const char filename[], const sketch_parameters &parameters, const hash_sketch &hs)
+{
+    std::vector<uint64_t> mask_words;
+    boost::to_block_range(parameters.mask, std::back_inserter(mask_words));
+
+    sketch_file_header header;
+    std::memcpy(header.magic, SKETCH_FILE_MAGIC, sizeof(header.magic));
+    header.version = SKETCH_FILE_VERSION;
+    header.window_length = parameters.window_length;
+    header.hash_seed = parameters.hash_seed;
+    header.scale = parameters.scale;
+    header.num_hashes = hs.hashes.size();
+    header.mask_bits = parameters.mask.size();
+    header.mask_words = mask_words.size();
+
+    const std::string temporary_filename = std::string(filename) + ".tmp";
+    std::ofstream sketch_file(temporary_filename, std::ios::binary | std::ios::trunc);
+    if (!sketch_file.is_open())
+    {
+        std::cerr << "Error: Unable to open file " << temporary_filename << " for writing." << std::endl;
+        return false;
+    }
+    sketch_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    sketch_file.write(reinterpret_cast<const char *>(mask_words.data()), mask_words.size() * sizeof(uint64_t));
+    sketch_file.write(reinterpret_cast<const char *>(hs.hashes.data()), hs.hashes.size() * sizeof(uint64_t));
+    sketch_file.close();
+
+    if (!sketch_file || std::rename(temporary_filename.c_str(), filename) != 0)
+    {
+        std::cerr << "Error: Unable to write sketch file " << filename << "." << std::endl;
+        std::remove(temporary_filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief
+ * Maps a sketch file and checks its header
+ * The hashes are not copied, they point into the mapping
+ *
+ * @param filename path to the sketch file
+ */
+mapped_sketch::mapped_sketch(const char filename[]) : file(filename)
+{
+    if (!file.good() || file.size < sizeof(sketch_file_header))
+        return;
+
+    sketch_file_header header;
+    std::memcpy(&header, file.data, sizeof(header));
+    if (std::memcmp(header.magic, SKETCH_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != SKETCH_FILE_VERSION)
+        return;
+
+    // The hashes must end exactly at the end of the file, or the file was truncated or is not a sketch file
+    const size_t mask_offset = sizeof(sketch_file_header);
+    const size_t hashes_offset = mask_offset + (size_t)header.mask_words * sizeof(uint64_t);
+    if ((size_t)header.mask_words * 64 < header.mask_bits ||
+        file.size < hashes_offset ||
+        (file.size - hashes_offset) / sizeof(uint64_t) != header.num_hashes ||
+        (file.size - hashes_offset) % sizeof(uint64_t) != 0)
+        return;
+
+    const uint64_t *mask_words = reinterpret_cast<const uint64_t *>(file.data + mask_offset);
+    parameters.window_length = header.window_length;
+    parameters.mask = kmer_bitset(mask_words, mask_words + header.mask_words);
+    parameters.mask.resize(header.mask_bits);
+    parameters.hash_seed = header.hash_seed;
+    parameters.scale = header.scale;
+
+    // The mapping is page-aligned and every section a multiple of 8 bytes, so the hashes can be used in place
+    hashes = reinterpret_cast<const uint64_t *>(file.data + hashes_offset);
+    num_hashes = header.num_hashes;
+    is_good = true;
+}
+
+/**
+ * @brief
+ * Copies the hashes of the mapped sketch into a hash_sketch
+ *
+ * @return hash_sketch
+ */
+hash_sketch mapped_sketch::to_hash_sketch() const
+{
+    hash_sketch hs;
+    hs.hashes.assign(hashes, hashes + num_hashes);
+    return hs;
+}
+
+/**
+ * @brief
+ * Helper function to compute the number of hashes in the intersection of two mapped sketches
+ *
+ * @param ms1 first mapped sketch
+ * @param ms2 second mapped sketch
+ * @return number of hashes in the intersection of the two sketches
+ */
+int mapped_sketch_intersection(const mapped_sketch &ms1, const mapped_sketch &ms2)
+{
+    if (!(ms1.parameters == ms2.parameters))
+        throw std::runtime_error("Sketch files for intersection computation were built with different parameters");
+    return sorted_hash_intersection(ms1.hashes, ms1.num_hashes, ms2.hashes, ms2.num_hashes);
+}
+
+/**
+ * @brief
+ * Helper function to compute mapped sketch intersections for a list of pairs of mapped sketches, computed pairwise
+ *
+ * @param mapped_sketches_1 first list of mapped_sketch pointers
+ * @param mapped_sketches_2 second list of mapped_sketch pointers
+ * @return list of ints representing the intersection size of the corresponding pair of sketches
+ */
+std::vector<int> compute_pairwise_mapped_sketch_intersections(
+    const std::vector<mapped_sketch *> &mapped_sketches_1,
+    const std::vector<mapped_sketch *> &mapped_sketches_2)
+{
+    if (mapped_sketches_1.size() != mapped_sketches_2.size())
+    {
+        throw std::runtime_error("Lists of mapped sketches for intersection computation have different lengths");
+    }
+    std::vector<int> intersection_values(mapped_sketches_1.size());
+    for (size_t i = 0; i < mapped_sketches_1.size(); ++i)
+    {
+        intersection_values[i] = mapped_sketch_intersection(*mapped_sketches_1[i], *mapped_sketches_2[i]);
+    }
+    return intersection_values;
+}
+
+/**
+ * @brief
+ * Parallel version of compute_pairwise_mapped_sketch_intersections using parallel_for
+ *
+ * @param mapped_sketches_1 first list of mapped_sketch pointers
+ * @param mapped_sketches_2 second list of mapped_sketch pointers
+ * @return list of ints representing the intersection size of the corresponding pair of sketches
+ */
+std::vector<int> parallel_compute_pairwise_mapped_sketch_intersections(
+    const std::vector<mapped_sketch *> &mapped_sketches_1,
+    const std::vector<mapped_sketch *> &mapped_sketches_2)
+{
+    if (PARALLEL_DISABLE)
+        return compute_pairwise_mapped_sketch_intersections(mapped_sketches_1, mapped_sketches_2);
+
+    if (mapped_sketches_1.size() != mapped_sketches_2.size())
+    {
+        throw std::runtime_error("Lists of mapped sketches for intersection computation have different lengths");
+    }
+    std::vector<int> intersection_values(mapped_sketches_1.size());
+    parallel_for(
+        (size_t)0,
+        mapped_sketches_1.size(),
+        [&](const size_t i)
+        {
+            intersection_values[i] = mapped_sketch_intersection(*mapped_sketches_1[i], *mapped_sketches_2[i]);
+        });
+    return intersection_values;
+}
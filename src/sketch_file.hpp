@@ -0,0 +1,124 @@
+/**
+ * @file sketch_file.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the binary sketch file format, used to sketch files once and compare them many times
+ *
+ * A sketch file holds, in native byte order and 8-byte aligned:
+ *  sketch_file_header             : magic, format version and sketch parameters
+ *  mask_words x uint64_t          : blocks of the spaced seed mask
+ *  num_hashes x uint64_t          : sorted, distinct hashes of the hash_sketch
+ * The hashes are used in place through mmap, so loading a sketch costs no parsing or copying
+ */
+#ifndef SKETCH_FILE_HPP
+#define SKETCH_FILE_HPP
+#include "kmer.hpp"
+#include "hash_sketch.hpp"
+#include "mapped_file.hpp"
+
+constexpr char SKETCH_FILE_MAGIC[8] = {'K', 'M', 'S', 'K', 'E', 'T', 'C', 'H'};
+
+/**
+ * @brief
+ * Extension given to sketch files
+ */
+constexpr const char *SKETCH_FILE_EXTENSION = ".sketch";
+
+/**
+ * @brief
+ * Version of the sketch file format, to be incremented whenever the layout or the hashing changes
+ */
+constexpr uint32_t SKETCH_FILE_VERSION = 1;
+
+/**
+ * @brief
+ * Parameters a hash_sketch was built with, which must match for two sketches to be compared
+ *
+ * @param window_length window size of the kmer
+ * @param mask spaced seed mask used
+ * @param hash_seed seed of the frac_min_hash whose hashes are stored
+ * @param scale scale of the FracMinHash policy, or 0 if the sketch was built with another policy
+ */
+struct sketch_parameters
+{
+    int window_length = 0;
+    kmer_bitset mask;
+    uint64_t hash_seed = 0;
+    uint64_t scale = 0;
+
+    bool operator==(const sketch_parameters &other) const = default;
+};
+
+/**
+ * @brief
+ * Fixed-size start of a sketch file
+ */
+struct sketch_file_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t window_length;
+    uint64_t hash_seed;
+    uint64_t scale;
+    uint64_t num_hashes;
+    uint32_t mask_bits;
+    uint32_t mask_words;
+};
+static_assert(sizeof(sketch_file_header) == 48, "sketch_file_header must have no padding");
+
+/**
+ * @brief
+ * Read-only view of a sketch file mapped into memory
+ * On failure (missing file, wrong magic or version, truncated file), good() returns false
+ *
+ * @param parameters parameters the sketch was built with
+ * @param hashes pointer to the sorted hashes inside the mapping
+ * @param num_hashes number of hashes
+ */
+struct mapped_sketch
+{
+    sketch_parameters parameters;
+    const uint64_t *hashes = nullptr;
+    size_t num_hashes = 0;
+
+    explicit mapped_sketch(const char filename[]);
+
+    inline bool good() const
+    {
+        return is_good;
+    }
+
+    /**
+     * @brief
+     * Helper function for computing the size of the sketch
+     *
+     * @return int
+     */
+    inline int sketch_size() const
+    {
+        return num_hashes;
+    }
+
+    hash_sketch to_hash_sketch() const;
+
+private:
+    mapped_file file;
+    bool is_good = false;
+};
+
+// Helper functions for identifying, writing and comparing sketch files
+bool is_sketch_file(const char filename[]);
+bool write_sketch_file(const char filename[], const sketch_parameters &parameters, const hash_sketch &hs);
+int mapped_sketch_intersection(const mapped_sketch &ms1, const mapped_sketch &ms2);
+std::vector<int> compute_pairwise_mapped_sketch_intersections(
+    const std::vector<mapped_sketch *> &mapped_sketches_1,
+    const std::vector<mapped_sketch *> &mapped_sketches_2);
+std::vector<int> parallel_compute_pairwise_mapped_sketch_intersections(
+    const std::vector<mapped_sketch *> &mapped_sketches_1,
+    const std::vector<mapped_sketch *> &mapped_sketches_2);
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * @file sketch_index.cpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This file contains the construction of the inverted index of hash sketches
+ */
+#include "sketch_index.hpp"
+
+#include <bit>
+
+/**
+ * @brief
+ * Number of high bits of the hashes used to split the construction of the index into buckets
+ * The bits are taken below the highest set bit of the largest hash, since FracMinHash sketches only keep small hashes
+ */
+constexpr int SKETCH_INDEX_BUCKET_BITS = 8;
+
+/**
+ * @brief
+ * Builds the inverted index of a list of hash sketches
+ * The (hash, sketch) entries are sorted by hash then by sketch one bucket of high hash bits at a time,
+ * since every sketch is sorted and holds each bucket in one contiguous range,
+ * so only one bucket of entries is held besides the index itself
+ * The runs of equal hashes in the sorted entries become the postings lists
+ *
+ * @param hash_sketches list of hash sketch pointers, whose positions in the list are the indices stored in the postings
+ */
+sketch_index::sketch_index(const std::vector<hash_sketch *> &hash_sketches)
+{
+    if (hash_sketches.size() > UINT32_MAX)
+        throw std::runtime_error("Too many hash sketches for an inverted index");
+
+    size_t total_size = 0;
+    uint64_t max_hash = 0;
+    for (const hash_sketch *hs : hash_sketches)
+    {
+        total_size += hs->hashes.size();
+        sketch_sizes.push_back(hs->sketch_size());
+        if (!hs->hashes.empty())
+            max_hash = std::max(max_hash, hs->hashes.back());
+    }
+    const int bucket_shift = std::max(0, (int)std::bit_width(max_hash) - SKETCH_INDEX_BUCKET_BITS);
+    postings.reserve(total_size);
+
+    // Position of every sketch in its hashes, at the start of the current bucket
+    std::vector<size_t> cursors(hash_sketches.size(), 0);
+    std::vector<std::pair<uint64_t, uint32_t>> entries;
+    for (uint64_t bucket = 0; bucket < (1ULL << SKETCH_INDEX_BUCKET_BITS); ++bucket)
+    {
+        entries.clear();
+        for (uint32_t i = 0; i < hash_sketches.size(); ++i)
+        {
+            const std::vector<uint64_t> &sketch_hashes = hash_sketches[i]->hashes;
+            for (; cursors[i] < sketch_hashes.size() && (sketch_hashes[cursors[i]] >> bucket_shift) == bucket; ++cursors[i])
+                entries.emplace_back(sketch_hashes[cursors[i]], i);
+        }
+        std::sort(entries.begin(), entries.end());
+
+        for (size_t e = 0; e < entries.size(); ++e)
+        {
+            if (e == 0 || entries[e].first != entries[e - 1].first)
+            {
+                hashes.push_back(entries[e].first);
+                posting_offsets.push_back(postings.size());
+            }
+            postings.push_back(entries[e].second);
+        }
+    }
+    posting_offsets.push_back(postings.size());
+
+    if (LOGGING)
+        std::clog << INFO_LOG << "Inverted index of " << hash_sketches.size() << " sketches: "
+                  << hashes.size() << " distinct hashes, " << postings.size() << " postings" << std::endl;
+}
+
+/**
+ * @brief
+ * Helper function for the postings list of a hash
+ *
+ * @param hash hash to look up
+ * @return range of the indices of the sketches containing hash, empty if no sketch contains it
+ */
+std::pair<const uint32_t *, const uint32_t *> sketch_index::postings_of(const uint64_t hash) const
+{
+    auto position = std::lower_bound(hashes.begin(), hashes.end(), hash);
+    if (position == hashes.end() || *position != hash)
+        return {postings.data(), postings.data()};
+    return postings_at(position - hashes.begin());
+}
@@ -0,0 +1,162 @@
+/**
+ * @file sketch_index.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the inverted index of a collection of hash sketches, mapping every hash to the sorted list
+ * (postings list) of the sketches containing it
+ *
+ * The intersections of every pair of sketches are then the product of the sparse sketch x hash matrix with its transpose:
+ * every sketch walks the postings lists of its hashes and counts the other sketches it meets in a dense counter,
+ * so the work is proportional to the number of shared hashes instead of to the number of pairs,
+ * and pairs sharing no hash are never visited
+ */
+#ifndef SKETCH_INDEX_HPP
+#define SKETCH_INDEX_HPP
+#include "kmer.hpp"
+#include "hash_sketch.hpp"
+#include "all_pairs.hpp"
+
+/**
+ * @brief
+ * Inverted index of a list of hash sketches, stored as compressed sparse rows
+ * The postings of hashes[h] are postings[posting_offsets[h]] to postings[posting_offsets[h + 1] - 1], in increasing order
+ *
+ * @param hashes sorted distinct hashes of every sketch
+ * @param posting_offsets start of the postings list of every hash, followed by the total number of postings
+ * @param postings indices of the sketches containing every hash
+ * @param sketch_sizes number of hashes of every sketch
+ */
+struct sketch_index
+{
+    std::vector<uint64_t> hashes;
+    std::vector<size_t> posting_offsets;
+    std::vector<uint32_t> postings;
+    std::vector<int> sketch_sizes;
+
+    explicit sketch_index(const std::vector<hash_sketch *> &hash_sketches);
+
+    /**
+     * @brief
+     * Helper function for the number of sketches in the index
+     */
+    inline size_t num_sketches() const
+    {
+        return sketch_sizes.size();
+    }
+
+    /**
+     * @brief
+     * Helper function for the postings list of the hash at a position of hashes
+     *
+     * @param position index in hashes
+     * @return range of the indices of the sketches containing hashes[position]
+     */
+    inline std::pair<const uint32_t *, const uint32_t *> postings_at(const size_t position) const
+    {
+        return {postings.data() + posting_offsets[position], postings.data() + posting_offsets[position + 1]};
+    }
+
+    std::pair<const uint32_t *, const uint32_t *> postings_of(const uint64_t hash) const;
+};
+
+/**
+ * @brief
+ * Sparse version of for_each_upper_triangle_intersection using an inverted index
+ * Only the pairs (i, j) with i < j sharing at least one hash are given to on_pairs, together with the self pairs
+ * if include_self_pairs
+ * Rows of sketches are split into blocks, each block using its own dense counter over the sketches,
+ * and the results are passed on, in increasing order of i, after every batch of blocks computed in parallel
+ *
+ * @param index inverted index of the sketches
+ * @param hash_sketches list of the sketches the index was built from, in the same order
+ * @param on_pairs callable taking a const std::vector<sketch_pair_intersection> &, called once per batch of blocks
+ * @param include_self_pairs whether the pairs (i, i) are included
+ * @param block_size number of sketches in each block of rows
+ */
+template <typename pairs_callable>
+void for_each_indexed_intersection(
+    const sketch_index &index,
+    const std::vector<hash_sketch *> &hash_sketches,
+    pairs_callable &&on_pairs,
+    const bool include_self_pairs = false,
+    const size_t block_size = DEFAULT_ALL_PAIRS_BLOCK_SIZE)
+{
+    if (block_size == 0)
+        throw std::runtime_error("Block size of the all-pairs comparison must be positive");
+    if (hash_sketches.size() != index.num_sketches())
+        throw std::runtime_error("Inverted index was not built from the given list of hash sketches");
+
+    const size_t num_sketches = index.num_sketches();
+    const size_t num_blocks = (num_sketches + block_size - 1) / block_size;
+    const size_t batch_size = 4 * (size_t)parallel_num_workers();
+    std::vector<std::vector<sketch_pair_intersection>> block_results(std::min(num_blocks, batch_size));
+    std::vector<sketch_pair_intersection> batch_results;
+
+    auto compute_block = [&](const size_t block, std::vector<sketch_pair_intersection> &results)
+    {
+        std::vector<int> counts(num_sketches, 0);
+        std::vector<uint32_t> touched;
+        results.clear();
+        for (size_t i = block * block_size; i < std::min((block + 1) * block_size, num_sketches); ++i)
+        {
+            // The hashes of the sketch are sorted, so their positions in the index only move forward
+            const std::vector<uint64_t> &row_hashes = hash_sketches[i]->hashes;
+            auto position = index.hashes.begin();
+            for (const uint64_t hash : row_hashes)
+            {
+                position = std::lower_bound(position, index.hashes.end(), hash);
+                auto [posting, postings_end] = index.postings_at(position - index.hashes.begin());
+
+                // Postings are sorted, so the ones of the upper triangle (j > i) are at the end
+                for (const uint32_t *j = postings_end; j != posting && *(j - 1) > i; --j)
+                {
+                    if (counts[*(j - 1)]++ == 0)
+                        touched.push_back(*(j - 1));
+                }
+            }
+
+            if (include_self_pairs)
+                results.push_back({i, i, index.sketch_sizes[i]});
+            std::sort(touched.begin(), touched.end());
+            for (const uint32_t j : touched)
+            {
+                results.push_back({i, j, counts[j]});
+                counts[j] = 0;
+            }
+            touched.clear();
+        }
+    };
+
+    for (size_t batch_begin = 0; batch_begin < num_blocks; batch_begin += batch_size)
+    {
+        const size_t batch_end = std::min(batch_begin + batch_size, num_blocks);
+
+        // Debug: If the PARALLEL_DISABLE flag is set to 0, use the serial version
+        if (PARALLEL_DISABLE)
+        {
+            for (size_t block = batch_begin; block < batch_end; ++block)
+                compute_block(block, block_results[block - batch_begin]);
+        }
+        else
+        {
+            parallel_for(
+                batch_begin,
+                batch_end,
+                [&](const size_t block)
+                {
+                    compute_block(block, block_results[block - batch_begin]);
+                });
+        }
+
+        batch_results.clear();
+        for (size_t block = batch_begin; block < batch_end; ++block)
+            batch_results.insert(batch_results.end(), block_results[block - batch_begin].begin(), block_results[block - batch_begin].end());
+        on_pairs(batch_results);
+    }
+}
+
+#endif
@@ -0,0 +1,219 @@
+/**
+ * @file sketch_operations.cpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This file contains the set operations on sorted hash sketches
+ */
+#include "sketch_operations.hpp"
+
+/**
+ * @brief
+ * Ranges of at most this many sketches are reduced serially instead of being split in two in parallel
+ */
+constexpr size_t SKETCH_REDUCTION_GRAIN = 2;
+
+/**
+ * @brief
+ * Downsamples a FracMinHash sketch to a coarser scale
+ * The coarser sketch keeps the hashes below a smaller threshold, which are a prefix of the sorted hashes
+ *
+ * @param hs FracMinHash sketch, built at a scale no coarser than scale
+ * @param scale new scale factor
+ * @return the sketch that would have been built at the new scale
+ */
+hash_sketch downsample_sketch(const hash_sketch &hs, const uint64_t scale)
+{
+    if (scale == 0)
+        throw std::runtime_error("Scale factor of a sketch must be positive");
+
+    hash_sketch downsampled;
+    downsampled.hashes.assign(
+        hs.hashes.begin(),
+        std::lower_bound(hs.hashes.begin(), hs.hashes.end(), frac_min_hash_threshold(scale)));
+    return downsampled;
+}
+
+/**
+ * @brief
+ * Helper function to compute the union of two hash sketches
+ *
+ * @param hs1 first hash_sketch
+ * @param hs2 second hash_sketch
+ * @return hash_sketch containing the hashes in either sketch
+ */
+hash_sketch sketch_union(const hash_sketch &hs1, const hash_sketch &hs2)
+{
+    hash_sketch result;
+    result.hashes.reserve(hs1.hashes.size() + hs2.hashes.size());
+    std::set_union(hs1.hashes.begin(), hs1.hashes.end(), hs2.hashes.begin(), hs2.hashes.end(), std::back_inserter(result.hashes));
+    return result;
+}
+
+/**
+ * @brief
+ * Helper function to compute the intersection of two hash sketches
+ *
+ * @param hs1 first hash_sketch
+ * @param hs2 second hash_sketch
+ * @return hash_sketch containing the hashes in both sketches
+ */
+hash_sketch sketch_intersection(const hash_sketch &hs1, const hash_sketch &hs2)
+{
+    hash_sketch result;
+    result.hashes.reserve(std::min(hs1.hashes.size(), hs2.hashes.size()));
+    std::set_intersection(hs1.hashes.begin(), hs1.hashes.end(), hs2.hashes.begin(), hs2.hashes.end(), std::back_inserter(result.hashes));
+    return result;
+}
+
+/**
+ * @brief
+ * Helper function to compute the difference of two hash sketches
+ *
+ * @param hs1 first hash_sketch
+ * @param hs2 second hash_sketch
+ * @return hash_sketch containing the hashes of the first sketch that are not in the second
+ */
+hash_sketch sketch_difference(const hash_sketch &hs1, const hash_sketch &hs2)
+{
+    hash_sketch result;
+    result.hashes.reserve(hs1.hashes.size());
+    std::set_difference(hs1.hashes.begin(), hs1.hashes.end(), hs2.hashes.begin(), hs2.hashes.end(), std::back_inserter(result.hashes));
+    return result;
+}
+
+/**
+ * @brief
+ * Downsamples every sketch of a collection in parallel using parallel_for
+ *
+ * @param hash_sketches list of hash_sketch pointers
+ * @param scale new scale factor
+ * @return list of the downsampled sketches
+ */
+std::vector<hash_sketch> parallel_downsample_sketches(const std::vector<hash_sketch *> &hash_sketches, const uint64_t scale)
+{
+    std::vector<hash_sketch> downsampled(hash_sketches.size());
+
+    // Debug: If the PARALLEL_DISABLE flag is set to 0, use the serial version
+    if (PARALLEL_DISABLE)
+    {
+        for (size_t i = 0; i < hash_sketches.size(); ++i)
+            downsampled[i] = downsample_sketch(*hash_sketches[i], scale);
+    }
+    else
+    {
+        parallel_for(
+            (size_t)0,
+            hash_sketches.size(),
+            [&](const size_t i)
+            {
+                downsampled[i] = downsample_sketch(*hash_sketches[i], scale);
+            });
+    }
+    return downsampled;
+}
+
+/**
+ * @brief
+ * Reduces a non-empty range of sketches with a binary operation, splitting it in two halves reduced in parallel
+ * The balanced tree keeps every merge between sketches of similar sizes, so the total work is O(n log k) for k sketches
+ *
+ * @param hash_sketches list of hash_sketch pointers
+ * @param begin first index of the range
+ * @param end one past the last index of the range
+ * @param op operation taking two hash_sketches and returning a hash_sketch
+ * @return reduction of the sketches of the range
+ */
+template <typename operation_callable>
+hash_sketch reduce_sketch_range(
+    const std::vector<hash_sketch *> &hash_sketches,
+    const size_t begin,
+    const size_t end,
+    operation_callable &op)
+{
+    if (end - begin == 1)
+        return *hash_sketches[begin];
+
+    const size_t middle = begin + (end - begin) / 2;
+    hash_sketch left, right;
+    if (PARALLEL_DISABLE || end - begin <= SKETCH_REDUCTION_GRAIN)
+    {
+        left = reduce_sketch_range(hash_sketches, begin, middle, op);
+        right = reduce_sketch_range(hash_sketches, middle, end, op);
+    }
+    else
+    {
+        parallel_invoke(
+            [&]
+            { left = reduce_sketch_range(hash_sketches, begin, middle, op); },
+            [&]
+            { right = reduce_sketch_range(hash_sketches, middle, end, op); });
+    }
+    return op(left, right);
+}
+
+/**
+ * @brief
+ * Computes the union of a collection of sketches in parallel
+ *
+ * @param hash_sketches list of hash_sketch pointers
+ * @return hash_sketch containing the hashes in any sketch
+ */
+hash_sketch parallel_sketch_union(const std::vector<hash_sketch *> &hash_sketches)
+{
+    if (hash_sketches.empty())
+        return hash_sketch();
+
+    auto op = [](const hash_sketch &hs1, const hash_sketch &hs2)
+    { return sketch_union(hs1, hs2); };
+    return reduce_sketch_range(hash_sketches, 0, hash_sketches.size(), op);
+}
+
+/**
+ * @brief
+ * Computes the intersection of a collection of sketches in parallel
+ *
+ * @param hash_sketches list of hash_sketch pointers
+ * @return hash_sketch containing the hashes in every sketch
+ */
+hash_sketch parallel_sketch_intersection(const std::vector<hash_sketch *> &hash_sketches)
+{
+    if (hash_sketches.empty())
+        return hash_sketch();
+
+    auto op = [](const hash_sketch &hs1, const hash_sketch &hs2)
+    { return sketch_intersection(hs1, hs2); };
+    return reduce_sketch_range(hash_sketches, 0, hash_sketches.size(), op);
+}
+
+/**
+ * @brief
+ * Converts a kmer_set into a FracMinHash hash_sketch, keeping the kmers whose hash is below the threshold of the scale
+ * The hashes are the ones frac_min_hash_policy compares, so a kmer_set built with that policy at the same scale is kept whole
+ *
+ * @param ks kmer_set to be converted
+ * @param fmh hash function of the sketch
+ * @param scale scale factor of the sketch
+ * @return hash_sketch of the kmers of the set
+ */
+hash_sketch hash_sketch_from_kmer_set(const kmer_set &ks, const frac_min_hash &fmh, const uint64_t scale)
+{
+    if (scale == 0)
+        throw std::runtime_error("Scale factor of a sketch must be positive");
+
+    const uint64_t threshold = frac_min_hash_threshold(scale);
+    hash_sketch hs;
+    hs.hashes.reserve(ks.kmer_set_size());
+    for (const auto &[k, count] : ks.kmer_hashes)
+    {
+        const uint64_t hash = fmh(k);
+        if (hash < threshold)
+            hs.hashes.push_back(hash);
+    }
+    std::sort(hs.hashes.begin(), hs.hashes.end());
+    hs.hashes.erase(std::unique(hs.hashes.begin(), hs.hashes.end()), hs.hashes.end());
+    return hs;
+}
@@ -0,0 +1,37 @@
+/**
+ * @file sketch_operations.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the set operations on built sketches, which derive new sketches without reading the .fasta
+ * files again: downsampling to a coarser scale, union, intersection and difference
+ *
+ * They all run on the sorted hash_sketch form, so every operation is a linear merge of sorted arrays
+ * Sketches combined together must have been built with the same parameters (see sketch_parameters), and the result
+ * has the parameters of its inputs (or the new scale, after downsampling)
+ * The collection versions reduce a list of sketches in parallel as a balanced tree, e.g. the union of all the assemblies
+ * of a species gives its pangenome sketch, and their intersection its core sketch
+ */
+#ifndef SKETCH_OPERATIONS_HPP
+#define SKETCH_OPERATIONS_HPP
+#include "kmer.hpp"
+#include "hash_sketch.hpp"
+
+// Helper functions for operations on two sketches
+hash_sketch downsample_sketch(const hash_sketch &hs, const uint64_t scale);
+hash_sketch sketch_union(const hash_sketch &hs1, const hash_sketch &hs2);
+hash_sketch sketch_intersection(const hash_sketch &hs1, const hash_sketch &hs2);
+hash_sketch sketch_difference(const hash_sketch &hs1, const hash_sketch &hs2);
+
+// Helper functions for operations on collections of sketches
+std::vector<hash_sketch> parallel_downsample_sketches(const std::vector<hash_sketch *> &hash_sketches, const uint64_t scale);
+hash_sketch parallel_sketch_union(const std::vector<hash_sketch *> &hash_sketches);
+hash_sketch parallel_sketch_intersection(const std::vector<hash_sketch *> &hash_sketches);
+
+// Helper function for converting a kmer_set into the sorted form
+hash_sketch hash_sketch_from_kmer_set(const kmer_set &ks, const frac_min_hash &fmh, const uint64_t scale);
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * @file sketch_pipeline.cpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This file contains the helper functions choosing the files sketched by the pipeline
+ */
+#include "sketch_pipeline.hpp"
+
+#include <filesystem>
+
+/**
+ * @brief
+ * Reads a manifest file listing one .fasta file name per line
+ * Leading and trailing whitespace is ignored, as are empty lines and lines starting with '#'
+ * Used instead of the command line for collections too large to fit in argv
+ *
+ * @param manifest_filename path to the manifest file
+ * @return list of the file names in the manifest, in order
+ */
+std::vector<std::string> read_manifest_file(const char manifest_filename[])
+{
+    std::ifstream manifest_file(manifest_filename);
+
+    // If unable to open the file, print and error and exit
+    if (!manifest_file.is_open())
+    {
+        std::cerr << "Unable to open " << manifest_filename << ". \n Exiting..." << std::endl;
+        exit(1);
+    }
+
+    std::vector<std::string> fasta_filenames;
+    std::string line;
+    while (std::getline(manifest_file, line))
+    {
+        const size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+        const size_t last = line.find_last_not_of(" \t\r");
+        fasta_filenames.push_back(line.substr(first, last - first + 1));
+    }
+
+    if (LOGGING)
+        std::clog << INFO_LOG << "Read " << fasta_filenames.size() << " file names from manifest " << manifest_filename << std::endl;
+    return fasta_filenames;
+}
+
+/**
+ * @brief
+ * Orders a list of files from largest to smallest, so that the longest jobs are started first
+ * Files whose size cannot be read are put last, and are reported when they are opened
+ *
+ * @param fasta_filenames list of file names
+ * @return indices into fasta_filenames, from the largest file to the smallest
+ */
+std::vector<size_t> largest_first_order(const std::vector<std::string> &fasta_filenames)
+{
+    std::vector<uintmax_t> file_sizes(fasta_filenames.size(), 0);
+    for (size_t i = 0; i < fasta_filenames.size(); ++i)
+    {
+        std::error_code error;
+        const uintmax_t file_size = std::filesystem::file_size(fasta_filenames[i], error);
+        if (!error)
+            file_sizes[i] = file_size;
+    }
+
+    std::vector<size_t> file_order(fasta_filenames.size());
+    for (size_t i = 0; i < file_order.size(); ++i)
+        file_order[i] = i;
+    std::stable_sort(
+        file_order.begin(),
+        file_order.end(),
+        [&](const size_t a, const size_t b)
+        { return file_sizes[a] > file_sizes[b]; });
+    return file_order;
+}
@@ -0,0 +1,222 @@
+/**
+ * @file sketch_pipeline.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the pipelined sketching scheduler for large collections of .fasta files
+ * The work on every file is split into three stages running on their own threads, connected by bounded queues:
+ *  read   : maps the file and asks the kernel to prefetch it, so the disk reads overlap with the other stages
+ *  encode : parses the mapped bytes into ACGT strings
+ *  sketch : sketches the ACGT strings
+ * Files are scheduled largest first, so the longest files do not start last and leave the other threads idle,
+ * and the bounded queues keep the reader and encoders from holding more than a few files in memory at once
+ */
+#ifndef SKETCH_PIPELINE_HPP
+#define SKETCH_PIPELINE_HPP
+#include <atomic>
+#include <exception>
+#include <thread>
+#include "kmer_set.hpp"
+#include "mapped_file.hpp"
+#include "bounded_queue.hpp"
+
+/**
+ * @brief
+ * Thread and queue sizes of the sketching pipeline
+ *
+ * @param num_encode_threads number of threads parsing files into ACGT strings
+ * @param num_sketch_threads number of threads sketching the ACGT strings
+ * @param queue_capacity maximum number of files waiting between two stages
+ */
+struct sketch_pipeline_options
+{
+    int num_encode_threads = std::max(1, (int)std::thread::hardware_concurrency() / 8);
+    int num_sketch_threads = std::max(1, (int)std::thread::hardware_concurrency());
+    size_t queue_capacity = 2 * std::max(1, (int)std::thread::hardware_concurrency());
+};
+
+// Helper functions for choosing the files to be sketched
+std::vector<std::string> read_manifest_file(const char manifest_filename[]);
+std::vector<size_t> largest_first_order(const std::vector<std::string> &fasta_filenames);
+
+/**
+ * @brief
+ * Sketches a list of .fasta files with the read, encode and sketch stages running concurrently (see the top of this file)
+ * The sketches are returned in the order of the file names, whatever order the files were processed in
+ *
+ * @tparam sketch_t sketch type returned by sketch_strings
+ * @tparam sketch_callable callable taking a const std::vector<acgt_string> & and returning a sketch_t,
+ *         called concurrently from several threads
+ * @param fasta_filenames list of file names to be read
+ * @param sketch_strings function sketching the ACGT strings of one file
+ * @param options thread and queue sizes
+ * @return a list of sketches corresponding to the file names given
+ */
+template <typename sketch_t, typename sketch_callable>
+std::vector<sketch_t> pipelined_sketches_from_fasta_files(
+    const std::vector<std::string> &fasta_filenames,
+    sketch_callable &&sketch_strings,
+    const sketch_pipeline_options &options = sketch_pipeline_options())
+{
+    std::vector<sketch_t> sketches(fasta_filenames.size());
+    const std::vector<size_t> file_order = largest_first_order(fasta_filenames);
+
+    // Debug: If the PARALLEL_DISABLE flag is set to 0, use the serial version
+    if (PARALLEL_DISABLE)
+    {
+        for (const size_t file_idx : file_order)
+            sketches[file_idx] = sketch_strings(nucleotide_strings_from_fasta_file(fasta_filenames[file_idx].c_str()));
+        return sketches;
+    }
+
+    struct mapped_fasta_file
+    {
+        size_t file_idx;
+        mapped_file file;
+    };
+    struct encoded_fasta_file
+    {
+        size_t file_idx;
+        std::vector<acgt_string> nucleotide_strings;
+    };
+    bounded_queue<mapped_fasta_file> mapped_queue(options.queue_capacity);
+    bounded_queue<encoded_fasta_file> encoded_queue(options.queue_capacity);
+
+    // The first exception thrown by any stage closes both queues, which makes every stage return early
+    std::exception_ptr stage_exception;
+    std::mutex stage_exception_mutex;
+    auto run_stage = [&](auto &&stage)
+    {
+        try
+        {
+            stage();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(stage_exception_mutex);
+            if (!stage_exception)
+                stage_exception = std::current_exception();
+            mapped_queue.close();
+            encoded_queue.close();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(
+        run_stage,
+        [&]
+        {
+            for (const size_t file_idx : file_order)
+            {
+                mapped_file fasta_file(fasta_filenames[file_idx].c_str());
+
+                // Thrown rather than exiting, so that run_stage closes the queues and the error reaches the caller once every stage is joined
+                if (!fasta_file.good())
+                    throw std::runtime_error("Unable to open " + fasta_filenames[file_idx]);
+                fasta_file.prefetch();
+                if (!mapped_queue.push({file_idx, std::move(fasta_file)}))
+                    return;
+            }
+            mapped_queue.close();
+        });
+
+    // The last encoder to run out of files closes the queue to the sketchers
+    std::atomic<int> num_running_encoders = options.num_encode_threads;
+    for (int i = 0; i < options.num_encode_threads; ++i)
+    {
+        threads.emplace_back(
+            run_stage,
+            [&]
+            {
+                while (std::optional<mapped_fasta_file> mapped = mapped_queue.pop())
+                {
+                    encoded_fasta_file encoded{
+                        mapped->file_idx,
+                        nucleotide_strings_from_fasta_bytes(mapped->file.begin(), mapped->file.end())};
+                    mapped.reset(); // Unmap the file before waiting on the sketchers
+                    if (!encoded_queue.push(std::move(encoded)))
+                        return;
+                }
+                if (--num_running_encoders == 0)
+                    encoded_queue.close();
+            });
+    }
+
+    for (int i = 0; i < options.num_sketch_threads; ++i)
+    {
+        threads.emplace_back(
+            run_stage,
+            [&]
+            {
+                while (std::optional<encoded_fasta_file> encoded = encoded_queue.pop())
+                    sketches[encoded->file_idx] = sketch_strings(encoded->nucleotide_strings);
+            });
+    }
+
+    for (std::thread &thread : threads)
+        thread.join();
+    if (stage_exception)
+        std::rethrow_exception(stage_exception);
+    return sketches;
+}
+
+/**
+ * @brief
+ * Pipelined version of parallel_hash_sketches_from_fasta_files, for large collections of files
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param fasta_filenames list of file names to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ * @param fmh hash function whose hashes are stored in the sketches
+ * @param options thread and queue sizes of the pipeline
+ * @return a list of hash_sketches corresponding to the file names given
+ */
+template <sketching_policy policy_t>
+std::vector<hash_sketch> pipelined_hash_sketches_from_fasta_files(
+    const std::vector<std::string> &fasta_filenames,
+    const kmer_bitset &mask,
+    const int window_length,
+    const policy_t &policy,
+    const frac_min_hash &fmh,
+    const sketch_pipeline_options &options = sketch_pipeline_options())
+{
+    return pipelined_sketches_from_fasta_files<hash_sketch>(
+        fasta_filenames,
+        [&](const std::vector<acgt_string> &nucleotide_strings)
+        { return hash_sketch_from_nucleotide_strings(nucleotide_strings, mask, window_length, policy, fmh); },
+        options);
+}
+
+/**
+ * @brief
+ * Pipelined version of parallel_kmer_sets_from_fasta_files, for large collections of files
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param fasta_filenames list of file names to be read
+ * @param mask spaced seed mask used
+ * @param window_length window size of the kmer
+ * @param policy sketching policy deciding which kmers are used
+ * @param options thread and queue sizes of the pipeline
+ * @return a list of kmer_sets corresponding to the file names given
+ */
+template <sketching_policy policy_t>
+std::vector<kmer_set> pipelined_kmer_sets_from_fasta_files(
+    const std::vector<std::string> &fasta_filenames,
+    const kmer_bitset &mask,
+    const int window_length,
+    const policy_t &policy,
+    const sketch_pipeline_options &options = sketch_pipeline_options())
+{
+    return pipelined_sketches_from_fasta_files<kmer_set>(
+        fasta_filenames,
+        [&](const std::vector<acgt_string> &nucleotide_strings)
+        { return kmer_set_from_nucleotide_strings(nucleotide_strings, mask, window_length, policy); },
+        options);
+}
+
+#endif
@@ -0,0 +1,141 @@
+/**
+ * @file sketch_query.cpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This file contains the top k search of references for query sketches
+ */
+#include "sketch_query.hpp"
+#include "ani_estimator.hpp"
+
+/**
+ * @brief
+ * Finds the k references sharing the most hashes with a query, ties going to the smallest reference index
+ * References sharing no hash with the query are never returned, so fewer than k hits may be found
+ *
+ * @param index inverted index of the references
+ * @param references list of the reference sketches the index was built from
+ * @param query query sketch
+ * @param k number of references to return
+ * @return the top k references, closest first
+ */
+std::vector<query_hit> top_k_references(
+    const sketch_index &index,
+    const std::vector<hash_sketch *> &references,
+    const hash_sketch &query,
+    const size_t k)
+{
+    if (references.size() != index.num_sketches())
+        throw std::runtime_error("Inverted index was not built from the given list of reference sketches");
+
+    const std::vector<uint64_t> &query_hashes = query.hashes;
+    const size_t num_query_hashes = query_hashes.size();
+    if (k == 0 || num_query_hashes == 0)
+        return {};
+
+    std::vector<int> counts(index.num_sketches(), 0);
+    std::vector<uint32_t> touched;
+    std::vector<int> top_counts;
+
+    // Walk the postings until the kth best count is above anything a reference not met yet could reach
+    int threshold = 0;
+    size_t t = 0;
+    auto position = index.hashes.begin();
+    while (t < num_query_hashes)
+    {
+        position = std::lower_bound(position, index.hashes.end(), query_hashes[t]);
+        if (position != index.hashes.end() && *position == query_hashes[t])
+        {
+            auto [posting, postings_end] = index.postings_at(position - index.hashes.begin());
+            for (; posting != postings_end; ++posting)
+            {
+                if (counts[*posting]++ == 0)
+                    touched.push_back(*posting);
+            }
+        }
+        ++t;
+
+        if (t % QUERY_BOUND_INTERVAL == 0 && touched.size() >= k)
+        {
+            top_counts.clear();
+            for (const uint32_t r : touched)
+                top_counts.push_back(counts[r]);
+            std::nth_element(top_counts.begin(), top_counts.begin() + (k - 1), top_counts.end(), std::greater<int>());
+            threshold = top_counts[k - 1];
+            if (threshold > (int)(num_query_hashes - t))
+                break;
+        }
+    }
+
+    // Finish the candidates whose bound can still reach the kth best count
+    const int num_remaining_hashes = num_query_hashes - t;
+    std::vector<query_hit> hits;
+    for (const uint32_t r : touched)
+    {
+        if (std::min(counts[r] + num_remaining_hashes, index.sketch_sizes[r]) < threshold)
+            continue;
+
+        int intersection = counts[r];
+        if (num_remaining_hashes > 0)
+        {
+            const std::vector<uint64_t> &reference_hashes = references[r]->hashes;
+            const size_t start = std::lower_bound(reference_hashes.begin(), reference_hashes.end(), query_hashes[t]) - reference_hashes.begin();
+            intersection += sorted_hash_intersection(
+                query_hashes.data() + t,
+                num_remaining_hashes,
+                reference_hashes.data() + start,
+                reference_hashes.size() - start);
+        }
+        hits.push_back({r, intersection, containment(intersection, num_query_hashes)});
+    }
+
+    const size_t num_hits = std::min(k, hits.size());
+    std::partial_sort(
+        hits.begin(),
+        hits.begin() + num_hits,
+        hits.end(),
+        [](const query_hit &a, const query_hit &b)
+        { return a.intersection != b.intersection ? a.intersection > b.intersection : a.reference < b.reference; });
+    hits.resize(num_hits);
+    return hits;
+}
+
+/**
+ * @brief
+ * Parallel version of top_k_references for a list of queries using parallel_for
+ *
+ * @param index inverted index of the references
+ * @param references list of the reference sketches the index was built from
+ * @param queries list of query sketch pointers
+ * @param k number of references to return for every query
+ * @return the top k references of every query, closest first
+ */
+std::vector<std::vector<query_hit>> parallel_top_k_references(
+    const sketch_index &index,
+    const std::vector<hash_sketch *> &references,
+    const std::vector<hash_sketch *> &queries,
+    const size_t k)
+{
+    std::vector<std::vector<query_hit>> hits(queries.size());
+
+    // Debug: If the PARALLEL_DISABLE flag is set to 0, use the serial version
+    if (PARALLEL_DISABLE)
+    {
+        for (size_t q = 0; q < queries.size(); ++q)
+            hits[q] = top_k_references(index, references, *queries[q], k);
+    }
+    else
+    {
+        parallel_for(
+            (size_t)0,
+            queries.size(),
+            [&](const size_t q)
+            {
+                hits[q] = top_k_references(index, references, *queries[q], k);
+            });
+    }
+    return hits;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file sketch_query.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the query mode, which finds the k references of a collection closest to a query sketch
+ *
+ * References are ranked by the containment of the query in them, |query & reference| / |query|, which orders them
+ * the same way as the ANI estimate since the binomial estimator is increasing
+ * The query walks the postings of its hashes in the inverted index of the references (see sketch_index.hpp),
+ * and stops as soon as no reference it has not met yet can enter the top k: the count of a reference can grow by
+ * at most the number of hashes left, and never beyond the size of its sketch
+ * The few candidates that can still reach the top k are then finished by intersecting them with the rest of the query
+ */
+#ifndef SKETCH_QUERY_HPP
+#define SKETCH_QUERY_HPP
+#include "sketch_index.hpp"
+
+/**
+ * @brief
+ * Number of query hashes walked between two updates of the top k bound
+ */
+constexpr size_t QUERY_BOUND_INTERVAL = 64;
+
+/**
+ * @brief
+ * Reference found by a query
+ *
+ * @param reference index of the reference in the collection
+ * @param intersection number of hashes shared by the query and the reference
+ * @param containment containment of the query in the reference
+ */
+struct query_hit
+{
+    size_t reference;
+    int intersection;
+    double containment;
+};
+
+std::vector<query_hit> top_k_references(
+    const sketch_index &index,
+    const std::vector<hash_sketch *> &references,
+    const hash_sketch &query,
+    const size_t k);
+std::vector<std::vector<query_hit>> parallel_top_k_references(
+    const sketch_index &index,
+    const std::vector<hash_sketch *> &references,
+    const std::vector<hash_sketch *> &queries,
+    const size_t k);
+
+#endif
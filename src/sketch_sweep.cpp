@@ -0,0 +1,43 @@
+/**
+ * @file sketch_sweep.cpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This file contains the reading of the files shared by every configuration of a sweep
+ */
+#include "sketch_sweep.hpp"
+
+/**
+ * @brief
+ * Reads and encodes a list of files in parallel
+ *
+ * @param fasta_filenames list of file names
+ * @param is_file_needed whether every file is to be read, the others are left empty
+ * @return the list of ACGT strings of every file
+ */
+std::vector<std::vector<acgt_string>> parallel_nucleotide_strings_from_fasta_files(
+    const std::vector<std::string> &fasta_filenames,
+    const std::vector<bool> &is_file_needed)
+{
+    std::vector<std::vector<acgt_string>> nucleotide_strings(fasta_filenames.size());
+    auto read_file = [&](const size_t i)
+    {
+        if (is_file_needed[i])
+            nucleotide_strings[i] = nucleotide_strings_from_fasta_file(fasta_filenames[i].c_str());
+    };
+
+    // Debug: If the PARALLEL_DISABLE flag is set to 0, use the serial version
+    if (PARALLEL_DISABLE)
+    {
+        for (size_t i = 0; i < fasta_filenames.size(); ++i)
+            read_file(i);
+    }
+    else
+    {
+        parallel_for((size_t)0, fasta_filenames.size(), read_file);
+    }
+    return nucleotide_strings;
+}
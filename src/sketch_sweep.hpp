@@ -0,0 +1,142 @@
+/**
+ * @file sketch_sweep.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the parameter sweep, which sketches a list of files under many (window length, mask)
+ * configurations while reading and encoding every file only once
+ * The encoded files are kept in memory (2 bits per nucleotide) and shared read-only by every configuration,
+ * and the configurations sharing a window length are sketched in a single pass over each file
+ */
+#ifndef SKETCH_SWEEP_HPP
+#define SKETCH_SWEEP_HPP
+#include <map>
+#include <tuple>
+#include "kmer_set.hpp"
+#include "sketch_cache.hpp"
+
+// Helper function for reading and encoding a list of files once
+std::vector<std::vector<acgt_string>> parallel_nucleotide_strings_from_fasta_files(
+    const std::vector<std::string> &fasta_filenames,
+    const std::vector<bool> &is_file_needed);
+
+/**
+ * @brief
+ * Sketches every file under every configuration, reading and encoding every file once
+ * Only the window length and mask vary between configurations, the policy and hash function are shared
+ * If a cache is given, the sketches found in it are reused, only the files with a missing sketch are read,
+ * and the new sketches are added to it; the cache only holds FracMinHash sketches (see check_cached_policy)
+ *
+ * @tparam policy_t sketching policy (see sketching_policy.hpp)
+ * @param fasta_filenames list of file names to be read
+ * @param configurations sketch parameters of every configuration, whose hash_seed and scale must describe fmh and policy
+ * @param policy sketching policy deciding which kmers are used
+ * @param fmh hash function whose hashes are stored in the sketches
+ * @param cache sketch cache, or nullptr to sketch everything
+ * @return sketches[c][i] is the hash_sketch of file i under configuration c
+ */
+template <sketching_policy policy_t>
+std::vector<std::vector<hash_sketch>> sweep_hash_sketches_from_fasta_files(
+    const std::vector<std::string> &fasta_filenames,
+    const std::vector<sketch_parameters> &configurations,
+    const policy_t &policy,
+    const frac_min_hash &fmh,
+    sketch_cache *cache = nullptr)
+{
+    const size_t num_files = fasta_filenames.size();
+    std::vector<std::vector<hash_sketch>> sketches(configurations.size(), std::vector<hash_sketch>(num_files));
+
+    // (configuration, file) pairs still to be sketched
+    std::vector<std::pair<size_t, size_t>> missing_sketches;
+    std::vector<bool> is_file_needed(num_files, false);
+    for (size_t c = 0; c < configurations.size(); ++c)
+    {
+        if (fmh.hash_seed != configurations[c].hash_seed)
+            throw std::runtime_error("Hash function does not match the hash seed of the sketch parameters");
+        if (cache != nullptr)
+        {
+            if constexpr (std::is_same_v<policy_t, frac_min_hash_policy>)
+                check_cached_policy(policy, configurations[c]);
+            else
+                throw std::runtime_error("Only FracMinHash sketches can go through the sketch cache");
+        }
+
+        for (size_t i = 0; i < num_files; ++i)
+        {
+            std::optional<mapped_sketch> cached;
+            if (cache != nullptr)
+                cached = cache->lookup(fasta_filenames[i], configurations[c]);
+
+            if (cached)
+            {
+                sketches[c][i] = cached->to_hash_sketch();
+            }
+            else
+            {
+                missing_sketches.emplace_back(c, i);
+                is_file_needed[i] = true;
+            }
+        }
+    }
+
+    if (LOGGING)
+        std::clog << INFO_LOG << "Sweep of " << configurations.size() << " configurations over " << num_files << " files, "
+                  << missing_sketches.size() << " sketches to compute" << std::endl;
+    if (missing_sketches.empty())
+        return sketches;
+
+    const std::vector<std::vector<acgt_string>> nucleotide_strings = parallel_nucleotide_strings_from_fasta_files(fasta_filenames, is_file_needed);
+
+    // Configurations sharing a window length are sketched together in one pass of the multi-mask kernel
+    // They are also split by code word width (kmers of up to 32, 64 or more nucleotides),
+    // so that one long kmer does not widen the codes of all the others
+    // Every group is independent, which gives the workers enough tasks to balance uneven files
+    std::map<std::tuple<int, int, size_t>, std::vector<size_t>> group_configurations;
+    for (const auto &[c, i] : missing_sketches)
+    {
+        const int code_width = ((int)configurations[c].mask.count() / NUCLEOTIDE_BIT_SIZE - 1) / 32;
+        group_configurations[{configurations[c].window_length, code_width, i}].push_back(c);
+    }
+    const std::vector<std::pair<std::tuple<int, int, size_t>, std::vector<size_t>>> groups(group_configurations.begin(), group_configurations.end());
+
+    auto sketch_group = [&](const size_t g)
+    {
+        const auto &[window_length, code_width, i] = groups[g].first;
+        const std::vector<size_t> &group = groups[g].second;
+        std::vector<kmer_bitset> masks;
+        for (const size_t c : group)
+            masks.push_back(configurations[c].mask);
+
+        std::vector<hash_sketch> group_sketches = hash_sketches_from_nucleotide_strings(
+            nucleotide_strings[i],
+            masks,
+            window_length,
+            policy,
+            fmh);
+        for (size_t m = 0; m < group.size(); ++m)
+            sketches[group[m]][i] = std::move(group_sketches[m]);
+    };
+
+    // Debug: If the PARALLEL_DISABLE flag is set to 0, use the serial version
+    if (PARALLEL_DISABLE)
+    {
+        for (size_t g = 0; g < groups.size(); ++g)
+            sketch_group(g);
+    }
+    else
+    {
+        parallel_for((size_t)0, groups.size(), sketch_group);
+    }
+
+    if (cache != nullptr)
+    {
+        for (const auto &[c, i] : missing_sketches)
+            cache->store(fasta_filenames[i], configurations[c], sketches[c][i]);
+    }
+    return sketches;
+}
+
+#endif
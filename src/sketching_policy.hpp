@@ -0,0 +1,274 @@
+/**
+ * @file sketching_policy.hpp
+ * @author Benson Lin (bensonlinzl@gmail.com)
+ * @brief
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * This header file contains the sketching policies, which decide which kmers are kept in a sketch
+ * A policy is a template parameter of the sliding window, so its test is inlined into the hot loop
+ *
+ * Every policy provides:
+ *  accept_code(canonical_code) : test on the compacted canonical kmer, run on every window before a kmer is built
+ *  accept_kmer(kmer)           : test on the kmer record, run only on the windows that passed accept_code
+ *  finalise(sketch)            : called once on the finished kmer_set, hash_sketch, flat_kmer_set or abundance_sketch of a file
+ *  merge(other)                : combines the state of a copy of the policy that sketched another part of the same file,
+ *                                so that a file can be sketched in chunks and finalised once
+ */
+#ifndef SKETCHING_POLICY_HPP
+#define SKETCHING_POLICY_HPP
+#include "kmer.hpp"
+#include "hash_sketch.hpp"
+#include "abundance_sketch.hpp"
+#include "flat_kmer_set.hpp"
+
+/**
+ * @brief
+ * Requirements on a sketching policy (see the top of this file)
+ */
+template <typename policy_t>
+concept sketching_policy = requires(policy_t &policy, const uint64_t &code, const kmer &k, kmer_set &ks, hash_sketch &hs) {
+    { policy.accept_code(code) } -> std::convertible_to<bool>;
+    { policy.accept_kmer(k) } -> std::convertible_to<bool>;
+    policy.finalise(ks);
+    policy.finalise(hs);
+    policy.merge(policy);
+};
+
+/**
+ * @brief
+ * FracMinHash: keeps the kmers whose hash is below UINT64_MAX / scale
+ *
+ * @param fmh FracMinHash hash function
+ * @param hash_threshold kmers with hash below this are kept
+ */
+struct frac_min_hash_policy
+{
+    frac_min_hash fmh;
+    uint64_t hash_threshold;
+
+    frac_min_hash_policy(const frac_min_hash &fmh, const uint64_t scale)
+        : fmh(fmh), hash_threshold(frac_min_hash_threshold(scale)) {}
+
+    template <typename code_t>
+    inline bool accept_code(const code_t &canonical_code) const
+    {
+        return fmh.hash_code(canonical_code) < hash_threshold;
+    }
+
+    inline bool accept_kmer(const kmer &) const
+    {
+        return true;
+    }
+
+    template <typename sketch_t>
+    inline void finalise(sketch_t &) const {}
+
+    inline void merge(const frac_min_hash_policy &) {}
+};
+
+/**
+ * @brief
+ * ModHash: keeps the kmers whose hash is divisible by the modulus
+ *
+ * @param fmh hash function
+ * @param modulus a 1/modulus fraction of all kmers is kept
+ */
+struct mod_hash_policy
+{
+    frac_min_hash fmh;
+    uint64_t modulus;
+
+    mod_hash_policy(const frac_min_hash &fmh, const uint64_t modulus)
+        : fmh(fmh), modulus(modulus) {}
+
+    template <typename code_t>
+    inline bool accept_code(const code_t &canonical_code) const
+    {
+        return fmh.hash_code(canonical_code) % modulus == 0;
+    }
+
+    inline bool accept_kmer(const kmer &) const
+    {
+        return true;
+    }
+
+    template <typename sketch_t>
+    inline void finalise(sketch_t &) const {}
+
+    inline void merge(const mod_hash_policy &) {}
+};
+
+/**
+ * @brief
+ * Bottom-k: keeps the sketch_size kmers with the smallest hashes
+ * Accepted hashes go into a buffer of at most 2 * sketch_size hashes; once it is full, it is cut back to the sketch_size
+ * smallest distinct hashes, and the largest of them becomes the acceptance threshold, which tightens as the window slides
+ * This costs O(1) amortised per accepted kmer and fixed memory, without the allocations of a balanced tree
+ * Kmers accepted early can be pushed out later, and are removed from the sketch by finalise
+ * The policy is stateful, so every file needs its own copy
+ *
+ * @param fmh hash function
+ * @param sketch_size number of kmers kept (k)
+ * @param buffer hashes accepted since the last cut, holding the smallest sketch_size distinct hashes seen so far
+ * @param threshold hashes above it are rejected, UINT64_MAX until sketch_size distinct hashes have been seen
+ */
+struct bottom_k_policy
+{
+    frac_min_hash fmh;
+    size_t sketch_size;
+    std::vector<uint64_t> buffer;
+    uint64_t threshold = UINT64_MAX;
+
+    bottom_k_policy(const frac_min_hash &fmh, const size_t sketch_size)
+        : fmh(fmh), sketch_size(sketch_size) {}
+
+    template <typename code_t>
+    inline bool accept_code(const code_t &canonical_code)
+    {
+        if (sketch_size == 0)
+            return false;
+
+        // The threshold itself is still kept, so that every occurrence of a kept kmer is accepted and counted
+        const uint64_t hash = fmh.hash_code(canonical_code);
+        if (hash > threshold)
+            return false;
+
+        // Repeated kmers are accepted again, sets only count them once more
+        buffer.push_back(hash);
+        if (buffer.size() >= 2 * sketch_size)
+            cut_to_bottom_k(buffer, sketch_size, threshold);
+        return true;
+    }
+
+    inline bool accept_kmer(const kmer &) const
+    {
+        return true;
+    }
+
+    /**
+     * @brief
+     * Keeps the smallest sketch_size hashes seen by either policy
+     *
+     * @param other policy that sketched another part of the same file
+     */
+    inline void merge(const bottom_k_policy &other)
+    {
+        buffer.insert(buffer.end(), other.buffer.begin(), other.buffer.end());
+        cut_to_bottom_k(buffer, sketch_size, threshold);
+    }
+
+    /**
+     * @brief
+     * Removes the kmers whose hash was pushed out of the bottom-k after they were accepted
+     *
+     * @param ks kmer set built with this policy
+     */
+    inline void finalise(kmer_set &ks) const
+    {
+        if (buffer.empty())
+            return;
+        const uint64_t largest_kept_hash = largest_kept();
+        std::erase_if(
+            ks.kmer_hashes,
+            [&](const auto &entry)
+            { return fmh(entry.first) > largest_kept_hash; });
+    }
+
+    /**
+     * @brief
+     * Removes the hashes that were pushed out of the bottom-k after they were accepted
+     * The sketch must have been built with the same hash function as this policy
+     *
+     * @param hs hash sketch built with this policy
+     */
+    inline void finalise(hash_sketch &hs) const
+    {
+        if (buffer.empty())
+            return;
+        const uint64_t largest_kept_hash = largest_kept();
+        hs.hashes.erase(
+            std::upper_bound(hs.hashes.begin(), hs.hashes.end(), largest_kept_hash),
+            hs.hashes.end());
+    }
+
+    /**
+     * @brief
+     * Removes the hashes that were pushed out of the bottom-k after they were accepted, with their counts
+     *
+     * @param as abundance sketch built with this policy
+     */
+    inline void finalise(abundance_sketch &as) const
+    {
+        if (buffer.empty())
+            return;
+        const size_t num_kept = std::upper_bound(as.hashes.begin(), as.hashes.end(), largest_kept()) - as.hashes.begin();
+        as.hashes.resize(num_kept);
+        as.counts.resize(num_kept);
+    }
+
+    /**
+     * @brief
+     * Removes the kmers whose hash was pushed out of the bottom-k after they were accepted
+     *
+     * @param fs flat kmer set built with this policy
+     */
+    template <typename code_t>
+    inline void finalise(flat_kmer_set<code_t> &fs) const
+    {
+        if (buffer.empty())
+            return;
+        const uint64_t largest_kept_hash = largest_kept();
+        fs.retain_if(
+            [&](const code_t &code)
+            { return fmh.hash_code(code) <= largest_kept_hash; });
+    }
+
+private:
+    /**
+     * @brief
+     * Largest of the sketch_size smallest distinct hashes in the buffer, which must not be empty
+     */
+    inline uint64_t largest_kept() const
+    {
+        std::vector<uint64_t> kept = buffer;
+        uint64_t unused_threshold = UINT64_MAX;
+        cut_to_bottom_k(kept, sketch_size, unused_threshold);
+        return kept.back();
+    }
+};
+
+/**
+ * @brief
+ * Keeps the kmers satisfying an arbitrary predicate on kmers, such as a lambda
+ * The kmer record is built for every window, so prefer the hash policies above for sketching
+ *
+ * @tparam predicate_t callable taking a const kmer & and returning bool, may be a reference type
+ * @param predicate predicate deciding which kmers are used
+ */
+template <typename predicate_t>
+struct predicate_policy
+{
+    predicate_t predicate;
+
+    explicit predicate_policy(predicate_t predicate) : predicate(predicate) {}
+
+    template <typename code_t>
+    inline bool accept_code(const code_t &) const
+    {
+        return true;
+    }
+
+    inline bool accept_kmer(const kmer &k) const
+    {
+        return predicate(k);
+    }
+
+    template <typename sketch_t>
+    inline void finalise(sketch_t &) const {}
+
+    inline void merge(const predicate_policy &) {}
+};
+
+#endif
@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <algorithm>
+#include <numeric>
 #include <unordered_map>
 #include <iterator>
 #include <vector>